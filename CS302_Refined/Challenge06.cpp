@@ -1,69 +1,215 @@
-/* Program Name: Challenge 6
- * Student Name: Ar-Raniry Ar-Rasyid
- * Net ID: jzr266
- * Student ID: 000-663-921
- * Program Description: Finds DNA strands and lists them in alphabetical order */
-
-#include <bits/stdc++.h>
-
-using namespace std;
-
-void findStrand(const string &s)
-{
-    map<string, int> AGAIN;
-    // Map to track sequence appearances
-    set<string> nAGAIN;
-    // Set for unique ones
-
-    int length = s.size();
-    if (length < 9)
-    {
-        // Invalid if less than nine
-        cout << "-1" << endl;
-        return;
-    }
-
-    for (int i = 0; i <= length - 9; i++)
-    {
-        string sub = s.substr(i, 9);
-        // Take note of the 9 chars
-        if (AGAIN.find(sub) != AGAIN.end())
-        {
-            // if it's in the map already, it's AGAIN time
-            AGAIN[sub] = AGAIN[sub] + 1;
-        }
-        else
-        {
-            // Start counting if it aint
-            AGAIN[sub] = 1;
-        }
-
-        // Add to the map
-        if (AGAIN[sub] == 2)
-        {
-            nAGAIN.insert(sub);
-            // Add to the set
-        }
-    }
-
-    set<string>::iterator iterator;
-    for (iterator = nAGAIN.begin(); iterator != nAGAIN.end(); iterator++)
-    {
-        cout << *iterator << endl;
-        // Cout in alphabetical order
-    }
-
-    cout << "-1" << endl;
-}
-
-int main()
-{
-    string dna;
-    // Run the function made prior
-    while (getline(cin, dna))
-    {
-        findStrand(dna);
-    }
-    // Look how clean this main is !!!
-    return 0;
-}
+/* Program Name: Challenge 6
+ * Student Name: Ar-Raniry Ar-Rasyid
+ * Net ID: jzr266
+ * Student ID: 000-663-921
+ * Program Description: Finds DNA strands and lists them in alphabetical order */
+
+#include <bits/stdc++.h>
+
+using namespace std;
+
+// Two bits per base; A < C < G < T, so sorting the codes sorts the strands alphabetically
+int baseCode(char c)
+{
+    switch (c)
+    {
+    case 'A':
+        return 0;
+    case 'C':
+        return 1;
+    case 'G':
+        return 2;
+    case 'T':
+        return 3;
+    }
+    return -1;
+    // Anything else can't be packed
+}
+
+string decode(uint64_t code, int k)
+{
+    string strand(k, 'A');
+    for (int j = k - 1; j >= 0; j--)
+    {
+        strand[j] = "ACGT"[code & 3];
+        code >>= 2;
+    }
+    return strand;
+}
+
+// Open addressing table from packed strand to how many times it's shown up (capped at 3), for k too big for a flat array
+class StrandTable
+{
+public:
+    StrandTable() : keys(1024), counts(1024, 0), used(0) {}
+
+    // Returns the count after this sighting
+    int add(uint64_t code)
+    {
+        if (2 * (used + 1) > keys.size())
+            grow();
+        size_t slot = find(code);
+        if (counts[slot] == 0)
+        {
+            keys[slot] = code;
+            used++;
+        }
+        if (counts[slot] < 3)
+            counts[slot]++;
+        return counts[slot];
+    }
+
+private:
+    vector<uint64_t> keys;
+    vector<uint8_t> counts;
+    // 0 means the slot is empty
+    size_t used;
+
+    size_t find(uint64_t code) const
+    {
+        size_t mask = keys.size() - 1;
+        size_t slot = (code * 0x9e3779b97f4a7c15ULL) >> 17 & mask;
+        while (counts[slot] != 0 && keys[slot] != code)
+            slot = (slot + 1) & mask;
+        return slot;
+    }
+
+    void grow()
+    {
+        vector<uint64_t> oldKeys;
+        vector<uint8_t> oldCounts;
+        oldKeys.swap(keys);
+        oldCounts.swap(counts);
+        keys.assign(oldKeys.size() * 2, 0);
+        counts.assign(oldKeys.size() * 2, 0);
+        for (size_t i = 0; i < oldKeys.size(); i++)
+        {
+            if (oldCounts[i] != 0)
+            {
+                size_t slot = find(oldKeys[i]);
+                keys[slot] = oldKeys[i];
+                counts[slot] = oldCounts[i];
+            }
+        }
+    }
+};
+
+// Prints every length-k strand that shows up more than once, alphabetically, then -1.
+// Strands are packed two bits per base and rolled along one base at a time, so no
+// substrings get built. Up to k = 9 the counts live in a flat 4^k array that's reused
+// across lines; past that they go in a hash table of 64-bit codes.
+void findStrand(const string &s, int k, vector<uint8_t> &flat)
+{
+    int length = s.size();
+    if (length < k)
+    {
+        // Invalid if shorter than a strand
+        cout << "-1" << endl;
+        return;
+    }
+
+    uint64_t mask = k == 32 ? ~0ULL : (1ULL << (2 * k)) - 1;
+    bool useFlat = k <= 9;
+    StrandTable table;
+
+    vector<uint64_t> repeats;
+    // Packed strands seen twice
+    map<string, int> odd;
+    // Strands with something other than ACGT in them, counted the old way
+    vector<string> oddRepeats;
+
+    uint64_t code = 0;
+    int run = 0;
+    // How many packable bases in a row end at i
+    for (int i = 0; i < length; i++)
+    {
+        int base = baseCode(s[i]);
+        if (base < 0)
+            run = 0;
+        else
+        {
+            code = ((code << 2) | base) & mask;
+            run++;
+        }
+        if (i < k - 1)
+            continue;
+
+        if (run >= k)
+        {
+            int count = useFlat ? (flat[code] < 3 ? ++flat[code] : 3) : table.add(code);
+            if (count == 2)
+                repeats.push_back(code);
+            // Counts stop at 3, so each strand hits 2 exactly once
+        }
+        else
+        {
+            string sub = s.substr(i - k + 1, k);
+            if (++odd[sub] == 2)
+                oddRepeats.push_back(sub);
+        }
+    }
+
+    // Flat counts are shared with the next line, so put back the zeros this one touched
+    if (useFlat)
+    {
+        code = 0;
+        run = 0;
+        for (int i = 0; i < length; i++)
+        {
+            int base = baseCode(s[i]);
+            if (base < 0)
+                run = 0;
+            else
+            {
+                code = ((code << 2) | base) & mask;
+                run++;
+            }
+            if (run >= k)
+                flat[code] = 0;
+        }
+    }
+
+    sort(repeats.begin(), repeats.end());
+    sort(oddRepeats.begin(), oddRepeats.end());
+
+    // Merge the two sorted lists so the output stays alphabetical
+    size_t o = 0;
+    for (size_t i = 0; i < repeats.size(); i++)
+    {
+        string strand = decode(repeats[i], k);
+        while (o < oddRepeats.size() && oddRepeats[o] < strand)
+            cout << oddRepeats[o++] << '\n';
+        cout << strand << '\n';
+    }
+    while (o < oddRepeats.size())
+        cout << oddRepeats[o++] << '\n';
+
+    cout << "-1" << endl;
+}
+
+int main(int argc, char **argv)
+{
+    int k = 9;
+    // Strand length, 9 unless asked otherwise
+    if (argc > 1)
+    {
+        k = atoi(argv[1]);
+        if (k < 1 || k > 32)
+        {
+            cerr << "usage: Challenge06 [k (1-32)]" << endl;
+            return 1;
+        }
+    }
+
+    vector<uint8_t> flat(k <= 9 ? (size_t)1 << (2 * k) : 0, 0);
+    // 2^18 counters for the usual k = 9, left all zero between lines
+
+    string dna;
+    // Run the function made prior
+    while (getline(cin, dna))
+    {
+        findStrand(dna, k, flat);
+    }
+    // Look how clean this main is !!!
+    return 0;
+}
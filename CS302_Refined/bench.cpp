@@ -0,0 +1,274 @@
+// bench.cpp
+// Overview: benchmark harness for the volsort modes. Generates random,
+// sorted, reversed, few-unique and numeric workloads at several sizes,
+// runs every *_sort function from volsort.h on each, and prints CSV:
+//
+//   mode,workload,size,ns_per_element,comparisons,allocations,peak_rss_kb
+//
+// Build it from the sort sources with the comparison counter turned on:
+//
+//   g++ -O2 -pthread -DVOLSORT_BENCH -o bench bench.cpp list.cpp stl.cpp
+//       qsort.cpp merge.cpp quick.cpp radix.cpp pmerge.cpp oblivious.cpp
+//       external.cpp
+//
+// bench -c instead runs regression checks on the external sort and exits
+// non-zero if any of them fails.
+
+#include "volsort.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+std::atomic<size_t> comparisons(0);
+std::atomic<size_t> allocations(0);
+
+// Count every heap allocation the sort makes
+void *operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+// kept out of line so the compiler doesn't flag free() against operator new
+__attribute__((noinline)) void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept {
+    operator delete(p);
+}
+
+struct Mode {
+    const char *name;
+    std::function<void(List &, bool)> sort;
+};
+
+struct Workload {
+    const char *name;
+    bool        numeric;
+};
+
+// Prototypes
+
+void generate(List &l, const Workload &workload, size_t size);
+bool is_sorted(const List &l, bool numeric);
+void run(const Mode &mode, const Workload &workload, size_t size);
+int external_run(const std::string &input, const std::string &output, size_t budget, size_t limit);
+bool check_external(size_t budget, size_t limit);
+int check();
+
+// Implementations
+
+// every workload is built from a fixed seed so runs are comparable
+void generate(List &l, const Workload &workload, size_t size) {
+    std::mt19937_64 rng(42);
+    std::string name = workload.name;
+    char buffer[32];
+
+    for (size_t i = 0; i < size; i++) {
+        // push_front reverses, so count down to end up ascending
+        if (name == "sorted") {
+            snprintf(buffer, sizeof(buffer), "%012zu", size - i);
+        } else if (name == "reversed") {
+            snprintf(buffer, sizeof(buffer), "%012zu", i);
+        } else if (name == "few-unique") {
+            snprintf(buffer, sizeof(buffer), "key%02llu", (unsigned long long)(rng() % 16));
+        } else if (name == "numeric") {
+            snprintf(buffer, sizeof(buffer), "%llu", (unsigned long long)(rng() % 1000000000000ULL));
+        } else {
+            size_t length = 4 + rng() % 20;
+            for (size_t j = 0; j < length; j++) {
+                buffer[j] = 'a' + rng() % 26;
+            }
+            buffer[length] = '\0';
+        }
+        l.push_front(buffer);
+    }
+}
+
+bool is_sorted(const List &l, bool numeric) {
+    for (Node *curr = l.head; curr && curr->next; curr = curr->next) {
+        int order = numeric ? number_order(curr, curr->next) : string_order(curr, curr->next);
+        if (order > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// runs one sort in a child process so peak RSS belongs to that run alone
+void run(const Mode &mode, const Workload &workload, size_t size) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+
+    if (pid == 0) {
+        List l;
+        generate(l, workload, size);
+
+        comparisons = 0;
+        allocations = 0;
+        auto start = std::chrono::steady_clock::now();
+        mode.sort(l, workload.numeric);
+        auto stop = std::chrono::steady_clock::now();
+        size_t compares = comparisons;
+        size_t allocs = allocations;
+
+        if (!is_sorted(l, workload.numeric)) {
+            fprintf(stderr, "bench: %s left %s/%zu unsorted\n", mode.name, workload.name, size);
+            _exit(1);
+        }
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+        printf("%s,%s,%zu,%.2f,%zu,%zu,%ld\n", mode.name, workload.name, size,
+               ns / size, compares, allocs, usage.ru_maxrss);
+        fflush(stdout);
+        _exit(0);
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+}
+
+// sorts the file input into the file output with external_sort, in a
+// child process since it reads stdin and writes stdout; returns its status
+int external_run(const std::string &input, const std::string &output, size_t budget, size_t limit) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+
+    if (pid == 0) {
+        if (!freopen(input.c_str(), "r", stdin) || !freopen(output.c_str(), "w", stdout)) {
+            _exit(2);
+        }
+        _exit(external_sort(false, budget, limit, [](List &chunk) { stl_sort(chunk, false); }));
+    }
+
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+
+// the merge plan for budget has to fit in it (or be the smallest plan,
+// two runs at a time, when nothing fits), and the sort has to print exactly
+// the first limit lines (-M with -k) of the right order
+bool check_external(size_t budget, size_t limit) {
+    size_t fan_in, buffer;
+    merge_plan(budget, fan_in, buffer);
+    bool ok = fan_in >= 2 && (fan_in + 1) * buffer <= std::max(budget, 3 * buffer);
+
+    std::mt19937_64 rng(budget);
+    std::vector<std::string> lines(2000);
+    char input[] = "/tmp/bench.XXXXXX";
+    char output[] = "/tmp/bench.XXXXXX";
+    int in = mkstemp(input);
+    int out = mkstemp(output);
+    if (in < 0 || out < 0) {
+        perror("mkstemp");
+        exit(1);
+    }
+    close(out);
+    FILE *file = fdopen(in, "w");
+    for (std::string &line : lines) {
+        line.assign(1 + rng() % 20, ' ');
+        for (char &c : line) {
+            c = 'a' + rng() % 26;
+        }
+        fprintf(file, "%s\n", line.c_str());
+    }
+    fclose(file);
+
+    std::sort(lines.begin(), lines.end());
+    lines.resize(std::min(lines.size(), limit));
+    ok = external_run(input, output, budget, limit) == 0 && ok;
+    std::ifstream sorted(output);
+    std::string line;
+    size_t count = 0;
+    while (std::getline(sorted, line)) {
+        ok = ok && count < lines.size() && line == lines[count];
+        count++;
+    }
+    ok = ok && count == lines.size();
+    unlink(input);
+    unlink(output);
+
+    printf("external -M %zu", budget);
+    if (limit != SIZE_MAX) {
+        printf(" -k %zu", limit);
+    }
+    printf(": fan-in %zu, buffer %zu  %s\n", fan_in, buffer, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+int check() {
+    int failures = 0;
+    for (size_t budget : {1000, 4 << 10, 12 << 10, 64 << 10, 1 << 20}) {
+        failures += !check_external(budget, SIZE_MAX);
+        failures += !check_external(budget, 5);
+    }
+    failures += !check_external(1 << 20, 0);
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "-c") == 0) {
+        return check();
+    }
+
+    // largest size defaults to a million, override with the first argument
+    size_t largest = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+    size_t threads = std::thread::hardware_concurrency();
+
+    std::vector<Mode> modes = {
+        {"stl",    stl_sort},
+        {"qsort",  qsort_sort},
+        {"merge",  merge_sort},
+        {"quick",  quick_sort},
+        {"radix",  radix_sort},
+        {"oblivious", oblivious_sort},
+        {"pmerge", [threads](List &l, bool numeric) { pmerge_sort(l, numeric, threads); }},
+    };
+    std::vector<Workload> workloads = {
+        {"random",     false},
+        {"sorted",     false},
+        {"reversed",   false},
+        {"few-unique", false},
+        {"numeric",    true},
+    };
+
+    printf("mode,workload,size,ns_per_element,comparisons,allocations,peak_rss_kb\n");
+    for (size_t size = 1000; size <= largest; size *= 10) {
+        for (const Workload &workload : workloads) {
+            for (const Mode &mode : modes) {
+                run(mode, workload, size);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -5,147 +5,1200 @@
 // dijsktras.cpp
 
 #include <iostream>
-#include <map>
-#include <queue>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdint>
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <getopt.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 using namespace std;
 
-// point in grid
-struct Point
+const int INF = 99999999; // unknown distance
+
+// map stored flat in row-major order, one byte per tile. The bytes either
+// live in storage (text maps) or point straight into a mapped binary file.
+struct Grid
 {
-    int row;
-    int col;
+    int rows;
+    int cols;
+    size_t cells;                  // rows * cols
+    const unsigned char *tiles;    // tiles[row * cols + col]
+    int cost[256];                 // cost of leaving a tile, indexed by its letter
+    int maxCost;                   // largest cost in the table
+    int minCost;                   // smallest cost in the table, for heuristics
+
+    vector<unsigned char> storage; // backing bytes for text maps
+    void *mapping;                 // backing mapping for binary maps
+    size_t mappingSize;
+
+    Grid()
+    {
+        rows = 0;
+        cols = 0;
+        cells = 0;
+        tiles = nullptr;
+        maxCost = 0;
+        minCost = 0;
+        mapping = nullptr;
+        mappingSize = 0;
+        fill(cost, cost + 256, 0);
+    }
 
-    Point(int r = 0, int c = 0)
+    ~Grid()
     {
-        row = r;
-        col = c;
+        if (mapping)
+        {
+            munmap(mapping, mappingSize);
+        }
     }
+
+    // tiles may point into this object, so it can't be copied
+    Grid(const Grid &) = delete;
+    Grid &operator=(const Grid &) = delete;
+};
+
+// binary map layout, all fields native-endian 32-bit:
+//   "GRD1", rows, cols, tile count, (letter, cost) per tile, then
+//   rows * cols bytes of tile letters, row-major
+struct BinaryHeader
+{
+    char magic[4];
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t numTiles;
 };
 
-// node in Dijkstra's algorithm
-struct Node
+// Dial's bucket queue: tile costs are small integers, so every key still in
+// the queue is within a fixed span of the smallest one (maxCost for plain
+// Dijkstra), and a ring of span + 1 buckets is enough to hold them all
+struct BucketQueue
 {
-    Point point;
-    int cost;
+    vector<vector<int>> buckets; // cells waiting at key d live in buckets[d % size]
+    size_t count;                // cells in all buckets
+    int current;                 // key being popped right now
+
+    BucketQueue(int span, int first = 0)
+    {
+        buckets.resize(span + 1);
+        count = 0;
+        current = first;
+    }
+
+    void push(int cell, int dist)
+    {
+        buckets[dist % buckets.size()].push_back(cell);
+        count++;
+    }
+
+    // pops a cell with the smallest distance, which is returned through dist
+    int pop(int &dist)
+    {
+        while (buckets[current % buckets.size()].empty())
+        {
+            current++;
+        }
+        vector<int> &bucket = buckets[current % buckets.size()];
+        int cell = bucket.back();
+        bucket.pop_back();
+        count--;
+        dist = current;
+        return cell;
+    }
+
+    // smallest key in the queue without removing it (may belong to a stale entry)
+    int top()
+    {
+        while (buckets[current % buckets.size()].empty())
+        {
+            current++;
+        }
+        return current;
+    }
+
+    bool empty() const
+    {
+        return count == 0;
+    }
 
-    Node(Point p, int c)
+    // empties the queue for the next search, keeping the bucket memory
+    void reset(int first = 0)
     {
-        point = p;
-        cost = c;
+        for (size_t i = 0; i < buckets.size(); i++)
+        {
+            buckets[i].clear();
+        }
+        count = 0;
+        current = first;
     }
 };
 
-// pick node with the lower cost, for priority queue
-struct CompareNodes
+// per-search distances and parents, reused across queries. Every write
+// stamps the cell with the current generation, and a cell whose stamp is
+// old reads as unvisited, so starting a new search is one increment
+// instead of refilling arrays the size of the map.
+struct Workspace
 {
-    bool operator()(Node &a, Node &b)
+    vector<int> dist;
+    vector<int> parent;
+    vector<unsigned> stamp;
+    unsigned generation;
+    BucketQueue pq;
+
+    Workspace() : generation(0), pq(0) {}
+
+    // gets ready for a new search over grid with a queue spanning span keys
+    void reset(const Grid &grid, int span, int first = 0)
+    {
+        size_t cells = grid.cells;
+        if (stamp.size() != cells)
+        {
+            dist.assign(cells, INF);
+            parent.assign(cells, -1);
+            stamp.assign(cells, 0);
+            generation = 0;
+        }
+        generation++;
+        // wrapped around: old stamps could look current again
+        if (generation == 0)
+        {
+            fill(stamp.begin(), stamp.end(), 0);
+            generation = 1;
+        }
+        if ((int)pq.buckets.size() != span + 1)
+        {
+            pq = BucketQueue(span, first);
+        }
+        pq.reset(first);
+    }
+
+    int distance(int cell) const
+    {
+        return stamp[cell] == generation ? dist[cell] : INF;
+    }
+
+    int parentOf(int cell) const
     {
-        return a.cost > b.cost;
+        return stamp[cell] == generation ? parent[cell] : -1;
     }
+
+    void set(int cell, int distance, int from)
+    {
+        stamp[cell] = generation;
+        dist[cell] = distance;
+        parent[cell] = from;
+    }
+};
+
+// which search main runs
+enum Algorithm
+{
+    DIJKSTRA,
+    ASTAR,
+    BIDIRECTIONAL,
+    DELTA_STEPPING
 };
 
-int main()
+// fills up to four neighbors of cell (up, right, down, left), returns how many
+inline int neighborsOf(const Grid &grid, int cell, int neighbors[4])
+{
+    int row = cell / grid.cols;
+    int col = cell % grid.cols;
+    int count = 0;
+    if (row > 0)             neighbors[count++] = cell - grid.cols;
+    if (col < grid.cols - 1) neighbors[count++] = cell + 1;
+    if (row < grid.rows - 1) neighbors[count++] = cell + grid.cols;
+    if (col > 0)             neighbors[count++] = cell - 1;
+    return count;
+}
+
+// reads the text format: tile table, dimensions, then the map itself
+bool readGrid(istream &in, Grid &grid)
 {
     // number of different tiles
     int numTiles;
-    cin >> numTiles;
+    if (!(in >> numTiles))
+    {
+        return false;
+    }
 
     // tile costs
-    map<char, int> costs;
     for (int i = 0; i < numTiles; i++)
     {
         char name;
         int cost;
-        cin >> name >> cost;
-        costs[name] = cost;
+        in >> name >> cost;
+        grid.cost[(unsigned char)name] = cost;
+        grid.maxCost = max(grid.maxCost, cost);
+        grid.minCost = (i == 0) ? cost : min(grid.minCost, cost);
     }
 
     // map dimensions
-    int rows, cols;
-    cin >> rows >> cols;
+    in >> grid.rows >> grid.cols;
 
     // map layout
-    vector<vector<char>> grid(rows, vector<char>(cols));
-    for (int i = 0; i < rows; i++)
+    grid.cells = (size_t)grid.rows * grid.cols;
+    grid.storage.resize(grid.cells);
+    for (size_t i = 0; i < grid.cells; i++)
     {
-        for (int j = 0; j < cols; j++)
+        char tile;
+        in >> tile;
+        grid.storage[i] = tile;
+    }
+    grid.tiles = grid.storage.data();
+    return (bool)in;
+}
+
+// maps a binary map file; the tiles are used in place, nothing is parsed
+bool loadBinaryGrid(const char *path, Grid &grid)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        cerr << "dijkstras: " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(BinaryHeader))
+    {
+        cerr << "dijkstras: " << path << " is not a binary map" << endl;
+        close(fd);
+        return false;
+    }
+
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        cerr << "dijkstras: " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    grid.mapping = map;
+    grid.mappingSize = st.st_size;
+
+    const BinaryHeader *header = (const BinaryHeader *)map;
+    size_t tableSize = sizeof(BinaryHeader) + (size_t)header->numTiles * 2 * sizeof(int32_t);
+    if (memcmp(header->magic, "GRD1", 4) != 0 || header->numTiles > 256 ||
+        tableSize + (size_t)header->rows * header->cols != grid.mappingSize)
+    {
+        cerr << "dijkstras: " << path << " is not a binary map" << endl;
+        return false;
+    }
+
+    // tile costs
+    const int32_t *table = (const int32_t *)(header + 1);
+    for (uint32_t i = 0; i < header->numTiles; i++)
+    {
+        int cost = table[2 * i + 1];
+        grid.cost[(unsigned char)table[2 * i]] = cost;
+        grid.maxCost = max(grid.maxCost, cost);
+        grid.minCost = (i == 0) ? cost : min(grid.minCost, cost);
+    }
+
+    grid.rows = header->rows;
+    grid.cols = header->cols;
+    grid.cells = (size_t)grid.rows * grid.cols;
+    grid.tiles = (const unsigned char *)map + tableSize;
+    madvise(map, grid.mappingSize, MADV_WILLNEED);
+    return true;
+}
+
+// writes grid in the binary layout above
+bool saveBinaryGrid(const char *path, const Grid &grid)
+{
+    BinaryHeader header;
+    memcpy(header.magic, "GRD1", 4);
+    header.rows = grid.rows;
+    header.cols = grid.cols;
+    header.numTiles = 0;
+
+    // every letter with a cost, plus any letter that appears on the map
+    vector<bool> used(256, false);
+    for (int i = 0; i < 256; i++)
+    {
+        used[i] = grid.cost[i] != 0;
+    }
+    for (size_t i = 0; i < grid.cells; i++)
+    {
+        used[grid.tiles[i]] = true;
+    }
+    vector<int32_t> table;
+    for (int i = 0; i < 256; i++)
+    {
+        if (used[i])
         {
-            cin >> grid[i][j];
+            table.push_back(i);
+            table.push_back(grid.cost[i]);
+            header.numTiles++;
         }
     }
 
-    // start and end positions
-    int startingRow, startingCol, endingRow, endingCol;
-    cin >> startingRow >> startingCol >> endingRow >> endingCol;
+    ofstream out(path, ios::binary);
+    out.write((const char *)&header, sizeof(header));
+    out.write((const char *)table.data(), table.size() * sizeof(int32_t));
+    out.write((const char *)grid.tiles, grid.cells);
+    return (bool)out;
+}
 
-    Point start(startingRow, startingCol);
-    Point end(endingRow, endingCol);
-    vector<vector<int>> distances(rows, vector<int>(cols, 99999999));       // unknown distances
-    vector<vector<Point>> parent(rows, vector<Point>(cols, Point(-1, -1))); // parent pointers for path reconstruction
-    priority_queue<Node, vector<Node>, CompareNodes> pq;                    // priority queue for Dijkstra's algorithm
+// Dijkstra's algorithm from start, stopping once end is settled
+// (pass end = -1 to settle the whole grid). With reverse set, edges are
+// walked backwards, so the result is each cell's distance *to* start.
+void dijkstra(const Grid &grid, int start, int end, Workspace &ws, bool reverse = false)
+{
+    ws.reset(grid, grid.maxCost);
+    BucketQueue &pq = ws.pq;
 
     // add starting point
-    distances[start.row][start.col] = 0;
-    pq.push(Node(start, 0));
-
-    // direction vectors
-    int dr[] = {-1, 0, 1, 0};
-    int dc[] = {0, 1, 0, -1};
+    ws.set(start, 0, -1);
+    pq.push(start, 0);
 
-    // Dijkstra's algorithm
     while (!pq.empty())
     {
-        // get node with smallest cost
-        Node current = pq.top();
-        pq.pop();
+        // get cell with smallest cost
+        int dist;
+        int current = pq.pop(dist);
 
-        Point currentPoint = current.point;
+        // stale entry, a shorter path to this cell was already handled
+        if (dist != ws.distance(current))
+        {
+            continue;
+        }
+        if (current == end)
+        {
+            return;
+        }
+
+        int leaving = grid.cost[grid.tiles[current]]; // cost of leaving current tile
 
         // look through neighbors (up, right, down, left)
-        for (int i = 0; i < 4; i++)
+        int neighbors[4];
+        int count = neighborsOf(grid, current, neighbors);
+        for (int i = 0; i < count; i++)
+        {
+            // update, shorter path found
+            int next = neighbors[i];
+            int newCost = dist + (reverse ? grid.cost[grid.tiles[next]] : leaving);
+            if (newCost < ws.distance(next))
+            {
+                ws.set(next, newCost, current);
+                pq.push(next, newCost);
+            }
+        }
+    }
+}
+
+// ALT (A*, landmarks, triangle inequality) tables: exact distances from
+// and to a handful of landmark cells, computed once per map and saved in a
+// sidecar file. Because tile costs make edges directed, both are needed.
+struct Landmarks
+{
+    int count;
+    vector<int> cells;     // the landmark cells themselves
+    vector<int32_t> from;  // from[l * cells + v] = distance landmark l -> v
+    vector<int32_t> to;    // to[l * cells + v]   = distance v -> landmark l
+
+    Landmarks()
+    {
+        count = 0;
+    }
+};
+
+// admissible, consistent A* heuristic: every step costs at least minCost,
+// and with landmarks the triangle inequality gives d(v, end) >=
+// d(l, end) - d(l, v) and d(v, end) >= d(v, l) - d(end, l) for every l
+inline int heuristic(const Grid &grid, int cell, int end, const Landmarks *alt)
+{
+    int dr = abs(cell / grid.cols - end / grid.cols);
+    int dc = abs(cell % grid.cols - end % grid.cols);
+    int best = (dr + dc) * grid.minCost;
+
+    if (alt)
+    {
+        size_t cells = grid.cells;
+        for (int l = 0; l < alt->count; l++)
+        {
+            const int32_t *from = &alt->from[l * cells];
+            const int32_t *to = &alt->to[l * cells];
+            best = max(best, max(from[end] - from[cell], to[cell] - to[end]));
+        }
+    }
+    return best;
+}
+
+// A* from start to end; the workspace holds the real cost g, the queue is keyed on g + h
+void astar(const Grid &grid, int start, int end, Workspace &ws, const Landmarks *alt = nullptr)
+{
+    // one step moves g + h by at most maxCost + minCost, or by up to twice
+    // the largest edge once landmark bounds are in play
+    int first = heuristic(grid, start, end, alt);
+    ws.reset(grid, alt ? 2 * grid.maxCost : grid.maxCost + grid.minCost, first);
+    BucketQueue &pq = ws.pq;
+
+    ws.set(start, 0, -1);
+    pq.push(start, first);
+
+    while (!pq.empty())
+    {
+        int key;
+        int current = pq.pop(key);
+
+        // stale entry
+        int dist = ws.distance(current);
+        if (key != dist + heuristic(grid, current, end, alt))
+        {
+            continue;
+        }
+        if (current == end)
+        {
+            return;
+        }
+
+        int newCost = dist + grid.cost[grid.tiles[current]];
+
+        int neighbors[4];
+        int count = neighborsOf(grid, current, neighbors);
+        for (int i = 0; i < count; i++)
+        {
+            int next = neighbors[i];
+            if (newCost < ws.distance(next))
+            {
+                ws.set(next, newCost, current);
+                pq.push(next, newCost + heuristic(grid, next, end, alt));
+            }
+        }
+    }
+}
+
+// bidirectional Dijkstra: a forward search from start and a backward search
+// from end over reversed edges (stepping u -> v costs the tile at u), each
+// side expanding in turn from whichever queue has the smaller minimum. Once
+// the two minimums add up to at least the best meeting cost, nothing better
+// can exist. The path is stitched into the forward workspace so it prints
+// like the other searches.
+void bidirectional(const Grid &grid, int start, int end, Workspace &ws, Workspace &back)
+{
+    ws.reset(grid, grid.maxCost);
+    back.reset(grid, grid.maxCost);
+    ws.set(start, 0, -1);
+    back.set(end, 0, -1); // back's parent is the next cell toward end
+    ws.pq.push(start, 0);
+    back.pq.push(end, 0);
+
+    int best = (start == end) ? 0 : INF; // cheapest start -> end seen so far
+    int meet = start;                    // cell where that path crosses over
+
+    while (!ws.pq.empty() && !back.pq.empty() && ws.pq.top() + back.pq.top() < best)
+    {
+        bool fromStart = ws.pq.top() <= back.pq.top();
+        Workspace &side = fromStart ? ws : back;
+        Workspace &other = fromStart ? back : ws;
+
+        int key;
+        int current = side.pq.pop(key);
+        if (key != side.distance(current))
+        {
+            continue;
+        }
+
+        int neighbors[4];
+        int count = neighborsOf(grid, current, neighbors);
+        for (int i = 0; i < count; i++)
+        {
+            int next = neighbors[i];
+            // forward leaves current, backward arrives at current from next
+            int newCost = key + grid.cost[grid.tiles[fromStart ? current : next]];
+            if (newCost < side.distance(next))
+            {
+                side.set(next, newCost, current);
+                side.pq.push(next, newCost);
+            }
+            int through = side.distance(next) + other.distance(next);
+            if (other.distance(next) != INF && through < best)
+            {
+                best = through;
+                meet = next;
+            }
+        }
+    }
+
+    // splice the backward half onto the forward parents
+    for (int cell = meet; cell != end && best != INF; cell = back.parentOf(cell))
+    {
+        int next = back.parentOf(cell);
+        ws.set(next, ws.distance(next), cell);
+    }
+    ws.set(end, best, ws.parentOf(end));
+}
+
+// fingerprint of the tiles and cost table, so a sidecar built for a
+// different map is rejected instead of giving wrong answers (FNV-1a)
+uint64_t gridHash(const Grid &grid)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < grid.cells; i++)
+    {
+        hash = (hash ^ grid.tiles[i]) * 1099511628211ULL;
+    }
+    for (int i = 0; i < 256; i++)
+    {
+        hash = (hash ^ (uint32_t)grid.cost[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// picks landmarks spread over the map (each new one is the cell farthest
+// from all chosen so far, starting from the top-left corner) and runs a
+// full forward and backward Dijkstra from each
+void buildLandmarks(const Grid &grid, int count, Landmarks &alt)
+{
+    size_t cells = grid.cells;
+    count = (int)min((size_t)count, cells);
+    alt.count = count;
+    alt.cells.clear();
+    alt.from.assign((size_t)count * cells, 0);
+    alt.to.assign((size_t)count * cells, 0);
+
+    Workspace ws;
+    vector<int> nearest(cells, INF); // distance from the closest chosen landmark
+    int next = 0;
+    for (int l = 0; l < count; l++)
+    {
+        alt.cells.push_back(next);
+
+        dijkstra(grid, next, -1, ws);
+        for (size_t v = 0; v < cells; v++)
+        {
+            alt.from[l * cells + v] = ws.distance(v);
+            nearest[v] = min(nearest[v], ws.distance(v));
+        }
+        dijkstra(grid, next, -1, ws, true);
+        for (size_t v = 0; v < cells; v++)
+        {
+            alt.to[l * cells + v] = ws.distance(v);
+        }
+
+        next = max_element(nearest.begin(), nearest.end()) - nearest.begin();
+    }
+}
+
+// sidecar layout: "ALT1", rows, cols, landmark count (int32 each), map hash
+// (uint64), landmark cells, then every from table and every to table
+bool saveLandmarks(const char *path, const Grid &grid, const Landmarks &alt)
+{
+    ofstream out(path, ios::binary);
+    int32_t header[3] = {grid.rows, grid.cols, alt.count};
+    uint64_t hash = gridHash(grid);
+    vector<int32_t> cells(alt.cells.begin(), alt.cells.end());
+
+    out.write("ALT1", 4);
+    out.write((const char *)header, sizeof(header));
+    out.write((const char *)&hash, sizeof(hash));
+    out.write((const char *)cells.data(), cells.size() * sizeof(int32_t));
+    out.write((const char *)alt.from.data(), alt.from.size() * sizeof(int32_t));
+    out.write((const char *)alt.to.data(), alt.to.size() * sizeof(int32_t));
+    return (bool)out;
+}
+
+// loads a sidecar written by saveLandmarks; anything that does not match
+// the map exactly (size, landmark count, landmark cells) is rejected
+// before it is used to size or index the tables
+bool loadLandmarks(const char *path, const Grid &grid, Landmarks &alt)
+{
+    ifstream in(path, ios::binary | ios::ate);
+    streamoff size = in.tellg();
+    in.seekg(0);
+    char magic[4];
+    int32_t header[3];
+    uint64_t hash;
+
+    if (!in.read(magic, 4) || memcmp(magic, "ALT1", 4) != 0 ||
+        !in.read((char *)header, sizeof(header)) || !in.read((char *)&hash, sizeof(hash)))
+    {
+        cerr << "dijkstras: " << path << " is not a landmark file" << endl;
+        return false;
+    }
+    if (header[0] != grid.rows || header[1] != grid.cols || hash != gridHash(grid))
+    {
+        cerr << "dijkstras: " << path << " was built for a different map" << endl;
+        return false;
+    }
+
+    size_t cells = grid.cells;
+    size_t expected = 4 + sizeof(header) + sizeof(hash) + (size_t)header[2] * (1 + 2 * cells) * sizeof(int32_t);
+    if (header[2] <= 0 || (size_t)header[2] > cells || size < 0 || (size_t)size != expected)
+    {
+        cerr << "dijkstras: " << path << " is truncated or does not fit the map" << endl;
+        return false;
+    }
+
+    vector<int32_t> chosen(header[2]);
+    if (!in.read((char *)chosen.data(), chosen.size() * sizeof(int32_t)))
+    {
+        cerr << "dijkstras: " << path << " is truncated" << endl;
+        return false;
+    }
+    for (size_t l = 0; l < chosen.size(); l++)
+    {
+        if (chosen[l] < 0 || (size_t)chosen[l] >= cells)
+        {
+            cerr << "dijkstras: " << path << " has a landmark outside the map" << endl;
+            return false;
+        }
+    }
+
+    alt.count = header[2];
+    alt.from.resize((size_t)alt.count * cells);
+    alt.to.resize((size_t)alt.count * cells);
+    in.read((char *)alt.from.data(), alt.from.size() * sizeof(int32_t));
+    in.read((char *)alt.to.data(), alt.to.size() * sizeof(int32_t));
+    alt.cells.assign(chosen.begin(), chosen.end());
+    if (!in)
+    {
+        cerr << "dijkstras: " << path << " is truncated" << endl;
+        return false;
+    }
+    return true;
+}
+
+// fixed set of worker threads that all run the same job, one call per
+// phase; run() returns once every worker has finished it
+struct ThreadPool
+{
+    vector<thread> workers;
+    mutex lock;
+    condition_variable wake;
+    condition_variable done;
+    function<void(int)> job;
+    unsigned round;   // bumped for every job so workers can tell it is new
+    int busy;         // workers still running the current job
+    bool stopping;
+
+    ThreadPool(int count) : round(0), busy(0), stopping(false)
+    {
+        for (int id = 1; id < count; id++)
+        {
+            workers.emplace_back([this, id]() { work(id); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (size_t i = 0; i < workers.size(); i++)
         {
-            int newRow = currentPoint.row + dr[i];
-            int newCol = currentPoint.col + dc[i];
+            workers[i].join();
+        }
+    }
 
-            // if neighbor is in grid...
-            if (newRow >= 0 && newRow < rows && newCol >= 0 && newCol < cols)
+    int size() const
+    {
+        return workers.size() + 1;
+    }
+
+    // runs f(id) on every worker, the calling thread taking id 0
+    void run(const function<void(int)> &f)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            job = f;
+            busy = workers.size();
+            round++;
+        }
+        wake.notify_all();
+        f(0);
+
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [this]() { return busy == 0; });
+    }
+
+    void work(int id)
+    {
+        unsigned seen = 0;
+        while (true)
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&]() { return stopping || round != seen; });
+            if (stopping)
             {
-                int edgeCost = costs[grid[currentPoint.row][currentPoint.col]];         // find cost of leaving current tile
-                int newCost = distances[currentPoint.row][currentPoint.col] + edgeCost; // new total cost
+                return;
+            }
+            seen = round;
+            guard.unlock();
 
-                // update, shorter path found
-                if (newCost < distances[newRow][newCol])
+            job(id);
+
+            guard.lock();
+            if (--busy == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+};
+
+// parallel delta-stepping (Meyer & Sanders). Cells sit in buckets of
+// width delta by tentative distance; the lowest bucket is emptied in
+// rounds, and each round's frontier is relaxed by every thread at once.
+// A cell's distance and parent share one 64-bit word updated with a
+// compare-and-swap min, so they can never disagree. Every edge is at most
+// maxCost, so with delta >= maxCost each round only refills the current
+// bucket or the next few.
+struct DeltaStepper
+{
+    ThreadPool pool;
+    int delta;
+    vector<atomic<uint64_t>> label;   // distance << 32 | parent
+    vector<int> expanded;             // distance a cell was last expanded at
+    vector<int> touched;              // cells this search labeled, reset on the way out
+    vector<vector<int>> buckets;
+    vector<vector<vector<int>>> local; // per thread, per bucket, cells to add
+
+    DeltaStepper(int threads, int width) : pool(threads), delta(width), local(threads) {}
+
+    static uint64_t pack(int dist, int parent)
+    {
+        return ((uint64_t)(uint32_t)dist << 32) | (uint32_t)parent;
+    }
+
+    int distance(int cell) const
+    {
+        return label[cell].load(memory_order_relaxed) >> 32;
+    }
+
+    // lowers cell to dist via parent if that is an improvement
+    bool relax(int cell, int dist, int parent)
+    {
+        uint64_t old = label[cell].load(memory_order_relaxed);
+        uint64_t want = pack(dist, parent);
+        while ((int)(old >> 32) > dist)
+        {
+            if (label[cell].compare_exchange_weak(old, want, memory_order_relaxed))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void search(const Grid &grid, int start, int end, Workspace &ws)
+    {
+        size_t cells = grid.cells;
+        int threads = pool.size();
+        // labels are cleared once here, then each search puts back only the
+        // cells it touched, so a batch never pays for the whole map again
+        if (label.size() != cells)
+        {
+            label = vector<atomic<uint64_t>>(cells);
+            for (size_t v = 0; v < cells; v++)
+            {
+                label[v].store(pack(INF, -1), memory_order_relaxed);
+            }
+            expanded.assign(cells, -1);
+        }
+        buckets.assign(1, vector<int>());
+        touched.clear();
+        touched.push_back(start);
+
+        label[start].store(pack(0, -1), memory_order_relaxed);
+        buckets[0].push_back(start);
+
+        vector<int> frontier;
+        for (size_t b = 0; b < buckets.size(); b++)
+        {
+            while (!buckets[b].empty())
+            {
+                // keep cells still in this bucket that haven't been expanded at this distance
+                frontier.clear();
+                for (size_t i = 0; i < buckets[b].size(); i++)
+                {
+                    int cell = buckets[b][i];
+                    int dist = distance(cell);
+                    if ((size_t)(dist / delta) == b && expanded[cell] != dist)
+                    {
+                        expanded[cell] = dist;
+                        frontier.push_back(cell);
+                    }
+                }
+                buckets[b].clear();
+
+                // small rounds aren't worth waking the pool for
+                int active = frontier.size() < 1024 ? 1 : threads;
+                auto round = [&](int id) {
+                    if (id >= active)
+                    {
+                        return;
+                    }
+                    size_t lo = frontier.size() * id / active;
+                    size_t hi = frontier.size() * (id + 1) / active;
+                    for (size_t i = lo; i < hi; i++)
+                    {
+                        int current = frontier[i];
+                        int newCost = distance(current) + grid.cost[grid.tiles[current]];
+                        int neighbors[4];
+                        int count = neighborsOf(grid, current, neighbors);
+                        for (int n = 0; n < count; n++)
+                        {
+                            if (relax(neighbors[n], newCost, current))
+                            {
+                                size_t target = newCost / delta;
+                                if (local[id].size() <= target)
+                                {
+                                    local[id].resize(target + 1);
+                                }
+                                local[id][target].push_back(neighbors[n]);
+                            }
+                        }
+                    }
+                };
+                if (active == 1)
+                {
+                    round(0);
+                }
+                else
+                {
+                    pool.run(round);
+                }
+
+                // gather what every thread queued into the shared buckets
+                for (int id = 0; id < active; id++)
                 {
-                    distances[newRow][newCol] = newCost;
-                    parent[newRow][newCol] = currentPoint;
-                    pq.push(Node(Point(newRow, newCol), newCost));
+                    if (buckets.size() < local[id].size())
+                    {
+                        buckets.resize(local[id].size());
+                    }
+                    for (size_t t = b; t < local[id].size(); t++)
+                    {
+                        buckets[t].insert(buckets[t].end(), local[id][t].begin(), local[id][t].end());
+                        touched.insert(touched.end(), local[id][t].begin(), local[id][t].end());
+                        local[id][t].clear();
+                    }
                 }
             }
+
+            // everything left is at least (b + 1) * delta away, so end is final
+            if (distance(end) < (int)((b + 1) * delta))
+            {
+                break;
+            }
+        }
+
+        // copy just the path into the workspace so it prints like the others
+        ws.reset(grid, grid.maxCost);
+        for (int cell = end; cell != -1; )
+        {
+            uint64_t packed = label[cell].load(memory_order_relaxed);
+            int parent = (int32_t)(uint32_t)packed;
+            ws.set(cell, packed >> 32, parent);
+            cell = parent;
+        }
+
+        // every label that changed went through a bucket, so this undoes them all
+        for (size_t i = 0; i < touched.size(); i++)
+        {
+            label[touched[i]].store(pack(INF, -1), memory_order_relaxed);
+            expanded[touched[i]] = -1;
         }
     }
+};
 
-    vector<Point> path; // path to end
-    Point current = end;
+// runs the chosen search; bidirectional needs the second workspace, A*
+// uses the landmark tables when they were loaded, and delta-stepping
+// brings its own thread pool
+void solve(Algorithm algo, const Grid &grid, int start, int end, Workspace &ws, Workspace &back,
+           const Landmarks *alt, DeltaStepper *delta)
+{
+    switch (algo)
+    {
+    case DIJKSTRA:
+        dijkstra(grid, start, end, ws);
+        break;
+    case ASTAR:
+        astar(grid, start, end, ws, alt);
+        break;
+    case BIDIRECTIONAL:
+        bidirectional(grid, start, end, ws, back);
+        break;
+    case DELTA_STEPPING:
+        delta->search(grid, start, end, ws);
+        break;
+    }
+}
 
+// output total cost and path from start to end
+void printPath(ostream &out, const Grid &grid, int end, const Workspace &ws, vector<int> &path)
+{
     // follow parents back to start and add them to path
-    while (!(current.row == start.row && current.col == start.col))
+    path.clear();
+    for (int current = end; current != -1; current = ws.parentOf(current))
     {
         path.push_back(current);
-        current = parent[current.row][current.col];
     }
 
-    path.push_back(start); // add start point
-
     // reverse (start to end)
     reverse(path.begin(), path.end());
 
-    // output total cost and path
-    cout << distances[end.row][end.col] << endl;
-    for (vector<Point>::iterator it = path.begin(); it != path.end(); ++it)
+    out << ws.distance(end) << "\n";
+    for (size_t i = 0; i < path.size(); i++)
     {
-        cout << it->row << " " << it->col << endl;
+        out << path[i] / grid.cols << " " << path[i] % grid.cols << "\n";
     }
+}
+
+// reads "startRow startCol endRow endCol" pairs from in and prints the answer
+// to each; just one pair unless batch. A pair off the map is an error for a
+// single query, but a batch answers it with a cost of -1 and carries on, so
+// the answers stay in step with the queries.
+int answerQueries(istream &in, ostream &out, const Grid &grid, Algorithm algo, bool batch,
+                  const Landmarks *alt, DeltaStepper *delta)
+{
+    // buffers shared by every query
+    Workspace ws;
+    Workspace back;
+    vector<int> path;
 
+    int startingRow, startingCol, endingRow, endingCol;
+    for (int query = 1; in >> startingRow >> startingCol >> endingRow >> endingCol; query++)
+    {
+        if (startingRow < 0 || startingRow >= grid.rows || startingCol < 0 || startingCol >= grid.cols ||
+            endingRow < 0 || endingRow >= grid.rows || endingCol < 0 || endingCol >= grid.cols)
+        {
+            cerr << "dijkstras: query " << query << " is outside the map" << endl;
+            if (!batch)
+            {
+                return 1;
+            }
+            out << -1 << "\n";
+            continue;
+        }
+
+        int start = startingRow * grid.cols + startingCol;
+        int end = endingRow * grid.cols + endingCol;
+
+        solve(algo, grid, start, end, ws, back, alt, delta);
+        printPath(out, grid, end, ws, path);
+
+        if (!batch)
+        {
+            break;
+        }
+    }
     return 0;
 }
+
+// runs a small fixed batch through every algorithm, including a pair off
+// the map in the middle, and compares the answers with known ones
+int check()
+{
+    // the cheap route runs along the top row and down the right side
+    istringstream map("3  G 1  f 5  m 9  3 4\n"
+                      "G G G G\n"
+                      "f f f G\n"
+                      "m m m G\n");
+    const char *queries = "0 0 2 3\n"
+                          "0 0 9 9\n"
+                          "2 0 0 0\n";
+    const char *expected = "5\n0 0\n0 1\n0 2\n0 3\n1 3\n2 3\n"
+                           "-1\n"
+                           "14\n2 0\n1 0\n0 0\n";
+
+    Grid grid;
+    if (!readGrid(map, grid))
+    {
+        cerr << "dijkstras: could not read the check map" << endl;
+        return 1;
+    }
+    Landmarks alt;
+    buildLandmarks(grid, 2, alt);
+    DeltaStepper delta(2, grid.maxCost);
+
+    const char *names[] = {"dijkstra", "astar", "alt", "bidir", "delta"};
+    Algorithm algos[] = {DIJKSTRA, ASTAR, ASTAR, BIDIRECTIONAL, DELTA_STEPPING};
+    int failures = 0;
+    for (int i = 0; i < 5; i++)
+    {
+        istringstream in(queries);
+        ostringstream out;
+        answerQueries(in, out, grid, algos[i], true, i == 2 ? &alt : nullptr, &delta);
+        bool right = out.str() == expected;
+        cout << "batch with a bad pair, " << names[i] << ": " << (right ? "ok" : "WRONG") << endl;
+        failures += !right;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+void usage(int status)
+{
+    cerr << "usage: dijkstras [--algo dijkstra|astar|bidir|delta] [--batch] [--alt FILE] < map" << endl
+         << "       dijkstras [options] --map FILE < queries" << endl
+         << "       dijkstras --preprocess FILE [--landmarks N] < map" << endl
+         << "       dijkstras --convert FILE < map" << endl
+         << "       dijkstras --check" << endl
+         << "    --batch       after the map, answer every \"startRow startCol endRow endCol\" line" << endl
+         << "    --preprocess  compute landmark (ALT) tables for the map and save them to FILE" << endl
+         << "    --landmarks   how many landmarks to compute (default 8)" << endl
+         << "    --alt         load landmark tables from FILE and run A* with them" << endl
+         << "    --threads     worker threads for delta (default: all cores)" << endl
+         << "    --delta       bucket width for delta (default: largest tile cost)" << endl
+         << "    --convert     write the text map on stdin to FILE in the binary format" << endl
+         << "    --map         load a binary map from FILE; stdin then only holds queries" << endl
+         << "    --check       answer a built-in batch with every algorithm and compare" << endl;
+    exit(status);
+}
+
+int main(int argc, char *argv[])
+{
+    ios::sync_with_stdio(false);
+
+    Algorithm algo = DIJKSTRA;
+    bool batch = false;
+    const char *preprocess = nullptr;
+    const char *altFile = nullptr;
+    int landmarks = 8;
+    int threads = max(1u, thread::hardware_concurrency());
+    int width = 0;
+    const char *convert = nullptr;
+    const char *binary = nullptr;
+    static struct option options[] = {
+        {"algo",       required_argument, nullptr, 'a'},
+        {"batch",      no_argument,       nullptr, 'b'},
+        {"preprocess", required_argument, nullptr, 'p'},
+        {"landmarks",  required_argument, nullptr, 'l'},
+        {"alt",        required_argument, nullptr, 'L'},
+        {"threads",    required_argument, nullptr, 't'},
+        {"delta",      required_argument, nullptr, 'd'},
+        {"convert",    required_argument, nullptr, 'c'},
+        {"map",        required_argument, nullptr, 'm'},
+        {"check",      no_argument,       nullptr, 'C'},
+        {"help",       no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+    int c;
+    while ((c = getopt_long(argc, argv, "a:bp:l:L:t:d:c:m:Ch", options, nullptr)) != -1)
+    {
+        if (c == 'a' && strcmp(optarg, "dijkstra") == 0)
+        {
+            algo = DIJKSTRA;
+        }
+        else if (c == 'a' && strcmp(optarg, "astar") == 0)
+        {
+            algo = ASTAR;
+        }
+        else if (c == 'a' && strcmp(optarg, "bidir") == 0)
+        {
+            algo = BIDIRECTIONAL;
+        }
+        else if (c == 'a' && strcmp(optarg, "delta") == 0)
+        {
+            algo = DELTA_STEPPING;
+        }
+        else if (c == 't' && atoi(optarg) > 0)
+        {
+            threads = atoi(optarg);
+        }
+        else if (c == 'd' && atoi(optarg) > 0)
+        {
+            width = atoi(optarg);
+        }
+        else if (c == 'c')
+        {
+            convert = optarg;
+        }
+        else if (c == 'm')
+        {
+            binary = optarg;
+        }
+        else if (c == 'C')
+        {
+            return check();
+        }
+        else if (c == 'b')
+        {
+            batch = true;
+        }
+        else if (c == 'p')
+        {
+            preprocess = optarg;
+        }
+        else if (c == 'l' && atoi(optarg) > 0)
+        {
+            landmarks = atoi(optarg);
+        }
+        else if (c == 'L')
+        {
+            altFile = optarg;
+            algo = ASTAR;
+        }
+        else
+        {
+            usage(c == 'h' ? 0 : 1);
+        }
+    }
+
+    Grid grid;
+    if (binary)
+    {
+        if (!loadBinaryGrid(binary, grid))
+        {
+            return 1;
+        }
+    }
+    else if (!readGrid(cin, grid))
+    {
+        cerr << "dijkstras: could not read map" << endl;
+        return 1;
+    }
+
+    // converting only writes the binary map
+    if (convert)
+    {
+        if (!saveBinaryGrid(convert, grid))
+        {
+            cerr << "dijkstras: could not write " << convert << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // preprocessing only writes the sidecar, queries come in later runs
+    Landmarks alt;
+    if (preprocess)
+    {
+        buildLandmarks(grid, landmarks, alt);
+        if (!saveLandmarks(preprocess, grid, alt))
+        {
+            cerr << "dijkstras: could not write " << preprocess << endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (altFile && !loadLandmarks(altFile, grid, alt))
+    {
+        cerr << "dijkstras: computing " << landmarks << " landmarks instead" << endl;
+        buildLandmarks(grid, landmarks, alt);
+    }
+
+    unique_ptr<DeltaStepper> delta;
+    if (algo == DELTA_STEPPING)
+    {
+        delta.reset(new DeltaStepper(threads, width ? width : max(1, grid.maxCost)));
+    }
+
+    // start and end positions; one pair normally, as many as given in batch mode
+    return answerQueries(cin, cout, grid, algo, batch, altFile ? &alt : nullptr, delta.get());
+}
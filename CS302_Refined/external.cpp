@@ -0,0 +1,333 @@
+// external.cpp
+// Overview: external-memory sort - stdin is read in chunks that fit in the
+// memory budget, each chunk is sorted as a List and spilled to a temporary
+// run file, and the runs are k-way merged with buffered streaming I/O. The
+// merge fan-in is capped, so runs are merged in levels as they pile up and
+// only the runs in one merge are ever open at once. With a line limit (-k)
+// every run and every merge stops after that many lines, since no later
+// line can make it into the output.
+
+#include "volsort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+// stdio buffer per open run (and for stdout), sized from the budget
+const size_t MIN_RUN_BUFFER = 4 << 10;
+const size_t MAX_RUN_BUFFER = 1 << 20;
+
+// Most runs merged in one go
+const size_t MAX_FAN_IN = 64;
+
+// Room each line may need while its chunk is sorted (the array-based
+// modes copy the list into one or two pointer arrays)
+const size_t SORT_SCRATCH = 2 * sizeof(Node *);
+
+// std::string keeps this many characters inline before it allocates
+const size_t INLINE_STRING = std::string().capacity();
+
+// One spilled run and the line currently at its front
+struct Run {
+    FILE       *file;
+    char       *line;       // getline buffer, owned by the run
+    size_t      capacity;
+    ssize_t     length;     // -1 once the run is exhausted
+    long long   number;
+};
+
+// Runs wait on disk as named temporary files, closed, so only the runs
+// being merged hold a descriptor; whatever is still listed when the sort
+// finishes (or fails) is removed
+struct Spool {
+    std::vector<std::vector<std::string>> levels;  // levels[l]: runs of fan_in^l chunks
+
+    ~Spool() {
+        for (const std::vector<std::string> &level : levels) {
+            for (const std::string &path : level) {
+                unlink(path.c_str());
+            }
+        }
+    }
+};
+
+// Prototypes
+
+FILE *create_run(size_t buffer, std::string &path);
+bool open_runs(const std::vector<std::string> &paths, size_t buffer, std::vector<FILE *> &inputs);
+bool merge_runs(std::vector<std::string> &paths, bool numeric, size_t limit, size_t buffer, std::string &out);
+bool spill(List &data, bool numeric, size_t limit, FILE *out);
+bool merge(std::vector<FILE *> &inputs, bool numeric, size_t limit, FILE *out);
+bool advance(Run &run, bool numeric);
+
+// Implementations
+
+int external_sort(bool numeric, size_t budget, size_t limit, const std::function<void(List &)> &sort) {
+    size_t fan_in, buffer;
+    merge_plan(budget, fan_in, buffer);
+    size_t chunk_budget = budget > buffer ? budget - buffer : 0;
+
+    static char out_buffer[MAX_RUN_BUFFER];
+    setvbuf(stdout, out_buffer, _IOFBF, buffer);
+
+    // a full level is merged into one run on the next, like carrying in a
+    // base-fan_in counter, so runs never pile up
+    Spool spool;
+    std::string line;
+    bool more = true;
+
+    while (more) {
+        std::string path;
+        {
+            // fill one chunk, counting what it really holds: whole slabs as
+            // they are grabbed, heap string storage, and sort scratch
+            List data;
+            size_t used = 0;
+            while (more) {
+                bool new_slab = data.slabs.empty() || data.slab_used == slab_nodes(data.slabs.size() - 1);
+                size_t slab = new_slab ? slab_nodes(data.slabs.size()) * sizeof(Node) : 0;
+                if (data.size > 0 && used + slab >= chunk_budget) {
+                    break;
+                }
+                if (!(more = (bool)std::getline(std::cin, line))) {
+                    break;
+                }
+                data.push_front(line);
+                size_t capacity = data.head->string.capacity();
+                used += slab + SORT_SCRATCH + (capacity > INLINE_STRING ? capacity + 1 : 0);
+            }
+            if (data.size == 0) {
+                break;
+            }
+            if (more && std::cin.peek() == EOF) {
+                more = false;
+            }
+            sort(data);
+
+            // everything fit in one chunk: no need to touch the disk at all
+            if (spool.levels.empty() && !more) {
+                return spill(data, numeric, limit, stdout) && fflush(stdout) == 0 ? 0 : 1;
+            }
+
+            FILE *file = create_run(buffer, path);
+            bool ok = file && spill(data, numeric, limit, file);
+            if (file && fclose(file) != 0) {
+                ok = false;
+            }
+            if (!ok) {
+                if (file) {
+                    unlink(path.c_str());
+                }
+                std::cerr << "volsort: cannot write temporary run" << std::endl;
+                return 1;
+            }
+        }
+
+        // the chunk is gone; carry full levels upward
+        for (size_t l = 0; !path.empty(); l++) {
+            if (spool.levels.size() == l) {
+                spool.levels.emplace_back();
+            }
+            spool.levels[l].push_back(path);
+            path.clear();
+            if (spool.levels[l].size() == fan_in && !merge_runs(spool.levels[l], numeric, limit, buffer, path)) {
+                std::cerr << "volsort: cannot write temporary run" << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    // whatever is left, oldest chunks first, merged down to one final pass
+    std::vector<std::string> runs;
+    for (size_t l = spool.levels.size(); l-- > 0; ) {
+        runs.insert(runs.end(), spool.levels[l].begin(), spool.levels[l].end());
+    }
+    spool.levels.assign(2, std::vector<std::string>());
+    spool.levels[0].swap(runs);
+    while (spool.levels[0].size() > fan_in) {
+        std::vector<std::string> &current = spool.levels[0];
+        for (size_t i = 0; i < current.size(); i += fan_in) {
+            std::vector<std::string> group(current.begin() + i, current.begin() + std::min(current.size(), i + fan_in));
+            std::string merged;
+            if (!merge_runs(group, numeric, limit, buffer, merged)) {
+                std::cerr << "volsort: cannot write temporary run" << std::endl;
+                return 1;
+            }
+            spool.levels[1].push_back(merged);
+        }
+        spool.levels[0].swap(spool.levels[1]);
+        spool.levels[1].clear();
+    }
+
+    std::vector<FILE *> inputs;
+    if (!open_runs(spool.levels[0], buffer, inputs)) {
+        std::cerr << "volsort: cannot read temporary run" << std::endl;
+        return 1;
+    }
+    if (!merge(inputs, numeric, limit, stdout)) {
+        return 1;
+    }
+    return 0;
+}
+
+// the merge holds fan_in input buffers plus one for its output, so both
+// come out of the budget; budgets too small for three buffers just merge
+// two at a time in more passes, and the fan-in never needs more
+// descriptors than we may open
+void merge_plan(size_t budget, size_t &fan_in, size_t &buffer) {
+    size_t slots = budget / MIN_RUN_BUFFER;
+    fan_in = slots > 2 ? std::min(MAX_FAN_IN, slots - 1) : 2;
+    struct rlimit files;
+    if (getrlimit(RLIMIT_NOFILE, &files) == 0 && files.rlim_cur != RLIM_INFINITY && files.rlim_cur > 10) {
+        fan_in = std::max((size_t)2, std::min(fan_in, (size_t)files.rlim_cur - 8));
+    }
+    buffer = std::max(MIN_RUN_BUFFER, std::min(MAX_RUN_BUFFER, budget / (fan_in + 1)));
+}
+
+// a new, empty run file named in path, with a stdio buffer of the given
+// size (it has to be set before the first write)
+FILE *create_run(size_t buffer, std::string &path) {
+    const char *dir = getenv("TMPDIR");
+    path = std::string(dir && *dir ? dir : "/tmp") + "/volsort.XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        return nullptr;
+    }
+    FILE *file = fdopen(fd, "w");
+    if (!file) {
+        close(fd);
+        unlink(path.c_str());
+        return nullptr;
+    }
+    setvbuf(file, nullptr, _IOFBF, buffer);
+    return file;
+}
+
+// opens every run in paths for reading; on failure nothing is left open
+bool open_runs(const std::vector<std::string> &paths, size_t buffer, std::vector<FILE *> &inputs) {
+    inputs.clear();
+    for (const std::string &path : paths) {
+        FILE *in = fopen(path.c_str(), "r");
+        if (!in) {
+            for (FILE *open : inputs) {
+                fclose(open);
+            }
+            inputs.clear();
+            return false;
+        }
+        setvbuf(in, nullptr, _IOFBF, buffer);
+        inputs.push_back(in);
+    }
+    return true;
+}
+
+// merges the runs in paths into a new run named in out; the inputs are
+// removed (and paths emptied) once the merged run is safely written
+bool merge_runs(std::vector<std::string> &paths, bool numeric, size_t limit, size_t buffer, std::string &out) {
+    std::vector<FILE *> inputs;
+    if (!open_runs(paths, buffer, inputs)) {
+        return false;
+    }
+    FILE *file = create_run(buffer, out);
+    if (!file) {
+        for (FILE *in : inputs) {
+            fclose(in);
+        }
+        return false;
+    }
+    bool ok = merge(inputs, numeric, limit, file);
+    if (fclose(file) != 0 || !ok) {
+        unlink(out.c_str());
+        out.clear();
+        return false;
+    }
+    for (const std::string &path : paths) {
+        unlink(path.c_str());
+    }
+    paths.clear();
+    return true;
+}
+
+// k-way merges the first limit lines of inputs into out, then closes the
+// inputs; the heap holds run indexes ordered by their front line
+bool merge(std::vector<FILE *> &inputs, bool numeric, size_t limit, FILE *out) {
+    std::vector<Run> runs(inputs.size());
+    auto later = [&runs, numeric](size_t a, size_t b) {
+        if (numeric && runs[a].number != runs[b].number) {
+            return runs[a].number > runs[b].number;
+        }
+        if (!numeric) {
+            size_t shorter = std::min(runs[a].length, runs[b].length);
+            int cmp = memcmp(runs[a].line, runs[b].line, shorter);
+            if (cmp != 0) {
+                return cmp > 0;
+            }
+            if (runs[a].length != runs[b].length) {
+                return runs[a].length > runs[b].length;
+            }
+        }
+        return a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+
+    for (size_t r = 0; r < runs.size(); r++) {
+        runs[r] = {inputs[r], nullptr, 0, -1, 0};
+        if (advance(runs[r], numeric)) {
+            heap.push(r);
+        }
+    }
+
+    for (size_t written = 0; written < limit && !heap.empty(); written++) {
+        size_t r = heap.top();
+        heap.pop();
+        fwrite(runs[r].line, 1, runs[r].length, out);
+        fputc('\n', out);
+        if (advance(runs[r], numeric)) {
+            heap.push(r);
+        }
+    }
+
+    for (Run &run : runs) {
+        free(run.line);
+        fclose(run.file);
+    }
+    inputs.clear();
+    return !ferror(out) && fflush(out) == 0;
+}
+
+// writes the first limit nodes of a sorted chunk in final output format,
+// one line per node
+bool spill(List &data, bool numeric, size_t limit, FILE *out) {
+    for (Node *curr = data.head; curr != nullptr && limit-- > 0; curr = curr->next) {
+        if (numeric) {
+            fprintf(out, "%lld\n", curr->number);
+        } else {
+            fwrite(curr->string.data(), 1, curr->string.size(), out);
+            fputc('\n', out);
+        }
+    }
+    return !ferror(out);
+}
+
+// loads the next line of a run, returns false when the run is used up
+bool advance(Run &run, bool numeric) {
+    run.length = getline(&run.line, &run.capacity, run.file);
+    if (run.length < 0) {
+        return false;
+    }
+    if (run.length > 0 && run.line[run.length - 1] == '\n') {
+        run.length--;
+    }
+    if (numeric) {
+        run.number = parse_number(run.line, run.length);
+    }
+    return true;
+}
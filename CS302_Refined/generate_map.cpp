@@ -4,56 +4,180 @@
  * Net ID: jzr266  
  * Student ID: 000-663-921  
  * Program Description: Create a map that Dijkstra's can navigate 
+ *
+ * usage: generate_map N [--seed S] [--terrain uniform|biomes]
+ *                       [--threads T] [--binary]
+ *
+ * Every tile comes from a counter-based PRNG (a hash of the seed and the
+ * tile's position), so the same seed always gives the same map no matter
+ * how many threads build it. Rows are built in blocks, in parallel, and
+ * each block is written with a single fwrite. --binary writes the compact
+ * GRD1 format that dijkstras --map reads instead of text.
  */
 
  #include <bits/stdc++.h>
+ #include <getopt.h>
  
  using namespace std;
+
+ // Constants for tiles and their weights
+ const char tileLetter[] = {'f', 'g', 'G', 'h', 'm', 'r'};
+ const int tileNumber[] = {3, 1, 2, 4, 7, 5};
+
+ // Biomes go from low to high ground: river, grass, G, forest, hills, mountains
+ const int biomeOrder[] = {5, 1, 2, 0, 3, 4};
+
+ // Height where each biome above river starts; blended noise bunches up
+ // around 0.5, so the bands are narrow in the middle to keep them even
+ const double biomeStart[] = {0.36, 0.44, 0.50, 0.56, 0.64};
+
+ // Rows handed to a thread at a time
+ const int BLOCK_ROWS = 64;
+
+ // splitmix64 finalizer: a good 64-bit mix, used as a counter-based PRNG
+ inline uint64_t mix(uint64_t x) {
+     x += 0x9e3779b97f4a7c15ULL;
+     x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+     x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+     return x ^ (x >> 31);
+ }
+
+ // Random number for (seed, row, col, salt), the same every time it's asked
+ inline uint64_t hashAt(uint64_t seed, uint64_t row, uint64_t col, uint64_t salt) {
+     return mix(seed ^ mix(row ^ mix(col ^ mix(salt))));
+ }
+
+ // Value noise in [0, 1): random heights on a lattice, smoothly blended
+ double noise(uint64_t seed, int row, int col, int spacing, int octave) {
+     int r0 = row / spacing, c0 = col / spacing;
+     double fr = (double)(row % spacing) / spacing;
+     double fc = (double)(col % spacing) / spacing;
+     // smoothstep so lattice lines don't show
+     fr = fr * fr * (3 - 2 * fr);
+     fc = fc * fc * (3 - 2 * fc);
+
+     auto corner = [&](int r, int c) {
+         return (hashAt(seed, r, c, octave) >> 11) * (1.0 / 9007199254740992.0);
+     };
+     double top = corner(r0, c0) * (1 - fc) + corner(r0, c0 + 1) * fc;
+     double bottom = corner(r0 + 1, c0) * (1 - fc) + corner(r0 + 1, c0 + 1) * fc;
+     return top * (1 - fr) + bottom * fr;
+ }
+
+ // Picks the tile (index into tileLetter) at row, col
+ int tileAt(uint64_t seed, bool biomes, int row, int col) {
+     if (!biomes) {
+         // Picks a number between 0 - 5, then chooses the corresponding tile
+         return hashAt(seed, row, col, 0) % 6;
+     }
+
+     // three octaves: big regions, then smaller patches, then a bit of grain
+     double height = 0.6 * noise(seed, row, col, 64, 1)
+                   + 0.3 * noise(seed, row, col, 16, 2)
+                   + 0.1 * noise(seed, row, col, 4, 3);
+     int band = 0;
+     while (band < 5 && height >= biomeStart[band]) {
+         band++;
+     }
+     return biomeOrder[band];
+ }
+
+ // Fills out with rows [first, last) in the chosen format
+ void buildRows(vector<char> &out, uint64_t seed, bool biomes, bool binary, int N, int first, int last) {
+     out.clear();
+     for (int i = first; i < last; i++) {
+         for (int j = 0; j < N; j++) {
+             out.push_back(tileLetter[tileAt(seed, biomes, i, j)]);
+             if (!binary) {
+                 out.push_back(j < N - 1 ? ' ' : '\n');
+             }
+         }
+     }
+ }
  
  int main(int argc, char* argv[]) {
-     int N;
- 
+     int N = 0;
+     uint64_t seed = time(0);
+     bool biomes = false;
+     bool binary = false;
+     int threads = max(1u, thread::hardware_concurrency());
+
+     static struct option options[] = {
+         {"seed",    required_argument, nullptr, 's'},
+         {"terrain", required_argument, nullptr, 'r'},
+         {"threads", required_argument, nullptr, 't'},
+         {"binary",  no_argument,       nullptr, 'b'},
+         {nullptr, 0, nullptr, 0}
+     };
+     int c;
+     while ((c = getopt_long(argc, argv, "s:r:t:b", options, nullptr)) != -1) {
+         if (c == 's') {
+             seed = strtoull(optarg, nullptr, 10);
+         } else if (c == 'r' && strcmp(optarg, "uniform") == 0) {
+             biomes = false;
+         } else if (c == 'r' && strcmp(optarg, "biomes") == 0) {
+             biomes = true;
+         } else if (c == 't' && atoi(optarg) > 0) {
+             threads = atoi(optarg);
+         } else if (c == 'b') {
+             binary = true;
+         } else {
+             cerr << "usage: generate_map N [--seed S] [--terrain uniform|biomes] [--threads T] [--binary]" << endl;
+             return 1;
+         }
+     }
+
      // Takes un user input
-     if (argc > 1) {
-         N = stoi(argv[1]);
+     if (optind < argc) {
+         N = stoi(argv[optind]);
      }
- 
-     // Get a random number, help from w3schools.com
-    srand(time(0));
- 
-     // Constants for tiles and their weights
-     const char tileLetter[] = {'f', 'g', 'G', 'h', 'm', 'r'};
-     const int tileNumber[] = {3, 1, 2, 4, 7, 5};
- 
-     // Cout tile info
-     cout << "6" << endl;
-     for (int i = 0; i < 6; i++) {
-         cout << tileLetter[i] << " " << tileNumber[i] << endl;
+
+     static char buffer[1 << 20];
+     setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+
+     if (binary) {
+         // GRD1 header: magic, rows, cols, tile count, then (letter, cost) pairs
+         uint32_t header[3] = {(uint32_t)N, (uint32_t)N, 6};
+         fwrite("GRD1", 1, 4, stdout);
+         fwrite(header, sizeof(header), 1, stdout);
+         for (int i = 0; i < 6; i++) {
+             int32_t entry[2] = {tileLetter[i], tileNumber[i]};
+             fwrite(entry, sizeof(entry), 1, stdout);
+         }
+     } else {
+         // Print tile info
+         printf("6\n");
+         for (int i = 0; i < 6; i++) {
+             printf("%c %d\n", tileLetter[i], tileNumber[i]);
+         }
+
+         // Print the graph the user wanted
+         printf("%d %d\n", N, N);
      }
- 
-     // Cout the graph the user wanted
-     cout << N << " " << N << endl;
- 
-     // Generate random map
-    for (int i = 0; i < N; i++) {
-        for (int j = 0; j < N; j++) {
-            int randTile = rand() % 6;
-            // Picks a number between 0 - 5, then chooses the corresponding tile
-            cout << tileLetter[randTile];
-
-            if (j < N - 1) {
-                cout << " ";
-            }
-        }
-        cout << endl;
-    }
- 
-     // Start at top left
-     cout << "0 0" << endl;
- 
-     // End at bottom right
-     cout << N - 1 << " " << N - 1 << endl;
- 
-     return 0;
+
+     // Generate the map a batch of blocks at a time, one block per thread,
+     // writing the blocks in order once the whole batch is built
+     vector<vector<char>> blocks(threads);
+     for (int first = 0; first < N; first += threads * BLOCK_ROWS) {
+         vector<thread> workers;
+         for (int t = 0; t < threads; t++) {
+             int lo = min(N, first + t * BLOCK_ROWS);
+             int hi = min(N, lo + BLOCK_ROWS);
+             workers.emplace_back(buildRows, ref(blocks[t]), seed, biomes, binary, N, lo, hi);
+         }
+         for (int t = 0; t < threads; t++) {
+             workers[t].join();
+             fwrite(blocks[t].data(), 1, blocks[t].size(), stdout);
+         }
+     }
+
+     if (!binary) {
+         // Start at top left
+         printf("0 0\n");
+
+         // End at bottom right
+         printf("%d %d\n", N - 1, N - 1);
+     }
+
+     return fflush(stdout) == 0 ? 0 : 1;
  }
- 
@@ -10,55 +10,61 @@ List::List()
   // Set head to nothing
   size = 0;
   // Size is 0 because there's nothing yet
+  slab_used = 0;
+  // No slabs yet, the first push grabs one
 }
 
 // Cleans the linked list
 List::~List()
 {
-  while (head)
+  // Sorting relinks nodes but never moves them, so walk the slabs directly
+  // instead of chasing next pointers all over memory
+  for (size_t i = 0; i < slabs.size(); i++)
   {
-    // Runs when there's elements
-    Node *temporary = head;
-    // Store head in temp var
-    head = head->next;
-    // Increment the head
-    delete temporary;
-    // Delete prev head
+    size_t used = (i + 1 == slabs.size()) ? slab_used : slab_nodes(i);
+    for (size_t j = 0; j < used; j++)
+    {
+      slabs[i][j].~Node();
+      // Only the string inside needs tearing down
+    }
+    ::operator delete(slabs[i]);
+    // Whole slab goes back in one shot
+  }
+  head = nullptr;
+}
+
+Node *List::allocate()
+{
+  if (slabs.empty() || slab_used == slab_nodes(slabs.size() - 1))
+  {
+    // Current slab is full, grab a fresh (bigger) one
+    slabs.push_back(static_cast<Node *>(::operator new(slab_nodes(slabs.size()) * sizeof(Node))));
+    slab_used = 0;
   }
+  // Construct in place at the next free slot
+  return new (&slabs.back()[slab_used++]) Node();
 }
 
 void List::push_front(const std::string &s)
 {
 
   // Creates a new node
-  Node *neoNode = new Node();
+  Node *neoNode = allocate();
 
   // Convert the node to string
   neoNode->string = s;
 
-  // Flag to check if num (number in spanish for flare :D)
-  bool numero = true;
-  // loop through each char in da string
-  for (char neoChar : s)
+  // Pack the first 8 bytes big-endian so comparing prefixes as integers
+  // gives the same order as comparing the bytes
+  neoNode->prefix = 0;
+  for (size_t i = 0; i < 8; i++)
   {
-    if (!isdigit(neoChar))
-    {
-      // if it aint a number mark it down as not a number
-      numero = false;
-      break;
-    }
+    unsigned char byte = i < s.size() ? s[i] : 0;
+    neoNode->prefix = (neoNode->prefix << 8) | byte;
   }
 
-  if (numero && !s.empty())
-  {
-    neoNode->number = stoi(s);
-    //  If string are numbers and not empty, stoi it
-  }
-  else
-  {
-    neoNode->number = 0;
-    // else put in default integer (zer0)
-  }
+  // All-digit lines get their value (stuck at LLONG_MAX if it's huge), else zer0
+  neoNode->number = parse_number(s.data(), s.size());
 
   neoNode->next = head;
   // next equal head (move it)
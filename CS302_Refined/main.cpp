@@ -7,27 +7,48 @@
 #include <strings.h>
 #include <unistd.h>
 #include <cstdlib>
+#include <thread>
 
 #define  MODE_STL       0
 #define  MODE_QSORT     1
 #define  MODE_MERGE     2
 #define  MODE_QUICK     3
 #define  MODE_OBLIVIOUS 4
+#define  MODE_RADIX     5
+#define  MODE_PMERGE    6
 
 // Utility functions -----------------------------------------------------------
 
 void usage(int status) {
     std::cout << "usage: volsort" << std::endl
-              << "    -m MODE   Sorting mode (oblivious, stl, qsort, merge, quick)" << std::endl
-              << "    -n        Perform numerical ordering"              << std::endl;
+              << "    -m MODE   Sorting mode (oblivious, stl, qsort, merge, quick, radix, pmerge)" << std::endl
+              << "    -n        Perform numerical ordering"              << std::endl
+              << "    -t N      Worker threads for pmerge (default: all cores)" << std::endl
+              << "    -f FILE   Map FILE and sort it in place of stdin (zero-copy; not with -M or -k)" << std::endl
+              << "    -M SIZE   Memory budget (e.g. 512M, 2G); spill sorted runs to disk" << std::endl
+              << "    -k K      Only print the K smallest lines (bounded heap, ignores -m)" << std::endl;
 
     exit(status);
 }
 
-void parse_command_line_options(int argc, char *argv[], int &mode, bool &numeric) {
+// parses sizes like 4096, 64K, 512M or 2G
+size_t parse_size(const char *s) {
+    char *end;
+    unsigned long long value = strtoull(s, &end, 10);
+    switch (*end) {
+        case 'g': case 'G': value <<= 10; // fall through
+        case 'm': case 'M': value <<= 10; // fall through
+        case 'k': case 'K': value <<= 10; end++; break;
+        case '\0': break;
+        default: return 0;
+    }
+    return *end == '\0' ? value : 0;
+}
+
+void parse_command_line_options(int argc, char *argv[], int &mode, bool &numeric, size_t &threads, const char *&file, size_t &budget, long long &top) {
     int c;
 
-    while ((c = getopt(argc, argv, "hm:n")) != -1) {
+    while ((c = getopt(argc, argv, "hm:nt:f:M:k:")) != -1) {
         switch (c) {
             case 'm':
                 if (strcasecmp(optarg, "stl") == 0) {
@@ -40,6 +61,10 @@ void parse_command_line_options(int argc, char *argv[], int &mode, bool &numeric
                     mode = MODE_QUICK;
         } else if (strcasecmp(optarg, "oblivious") == 0) {
           mode = MODE_OBLIVIOUS;
+                } else if (strcasecmp(optarg, "radix") == 0) {
+                    mode = MODE_RADIX;
+                } else if (strcasecmp(optarg, "pmerge") == 0) {
+                    mode = MODE_PMERGE;
                 } else {
                     usage(1);
                 }
@@ -47,6 +72,27 @@ void parse_command_line_options(int argc, char *argv[], int &mode, bool &numeric
             case 'n':
                 numeric = true;
                 break;
+            case 't':
+                if (atoi(optarg) < 1) {
+                    usage(1);
+                }
+                threads = atoi(optarg);
+                break;
+            case 'f':
+                file = optarg;
+                break;
+            case 'M':
+                budget = parse_size(optarg);
+                if (budget == 0) {
+                    usage(1);
+                }
+                break;
+            case 'k':
+                top = atoll(optarg);
+                if (top < 0) {
+                    usage(1);
+                }
+                break;
             case 'h':
                 usage(0);
                 break;
@@ -57,20 +103,7 @@ void parse_command_line_options(int argc, char *argv[], int &mode, bool &numeric
     }
 }
 
-// Main execution --------------------------------------------------------------
-
-int main(int argc, char *argv[]) {
-    int mode = MODE_STL;
-    bool numeric = false;
-    List data;
-    std::string line;
-
-    parse_command_line_options(argc, argv, mode, numeric);
-
-    while (std::getline(std::cin, line)) {
-      data.push_front(line);
-    }
-    
+void sort_list(List &data, int mode, bool numeric, size_t threads) {
     switch (mode) {
         case MODE_STL:
             stl_sort(data, numeric);
@@ -84,8 +117,65 @@ int main(int argc, char *argv[]) {
         case MODE_QUICK:
             quick_sort(data, numeric);
             break;
+        case MODE_OBLIVIOUS:
+            oblivious_sort(data, numeric);
+            break;
+        case MODE_RADIX:
+            radix_sort(data, numeric);
+            break;
+        case MODE_PMERGE:
+            pmerge_sort(data, numeric, threads);
+            break;
     }
-    
+}
+
+// Main execution --------------------------------------------------------------
+
+int main(int argc, char *argv[]) {
+    int mode = MODE_STL;
+    bool numeric = false;
+    size_t threads = std::thread::hardware_concurrency();
+    const char *file = nullptr;
+    size_t budget = 0;
+    long long top = -1;
+    List data;
+    std::string line;
+
+    parse_command_line_options(argc, argv, mode, numeric, threads, file, budget, top);
+
+    // the mapped path always sorts and prints the whole file in memory
+    if (file && (budget || top >= 0)) {
+        usage(1);
+    }
+
+    // the mapped path never builds a List, so it skips the per-line copies
+    if (file) {
+        return mmap_sort(file, numeric);
+    }
+
+    // with a budget, each chunk is sorted with the chosen mode and spilled;
+    // with -k too, a chunk only needs to keep its K smallest lines
+    if (budget) {
+        size_t limit = top >= 0 ? (size_t)top : SIZE_MAX;
+        return external_sort(numeric, budget, limit, [=](List &chunk) {
+            if (top >= 0) {
+                topk_sort(chunk, numeric, top);
+            } else {
+                sort_list(chunk, mode, numeric, threads);
+            }
+        });
+    }
+
+    while (std::getline(std::cin, line)) {
+      data.push_front(line);
+    }
+
+    if (top >= 0) {
+        topk_sort(data, numeric, top);
+    } else {
+        sort_list(data, mode, numeric, threads);
+    }
+
 
     for (Node * curr = data.head; curr != NULL; curr = curr->next) {
         if (numeric) {
@@ -55,7 +55,7 @@ Node *merge(Node *left, Node *right, bool numeric) {
 
     while (left && right) {
         // left
-        if ((numeric && left->number <= right->number) || (!numeric && left->string <= right->string)) {
+        if ((numeric && number_order(left, right) <= 0) || (!numeric && string_order(left, right) <= 0)) {
             tail->next = left; // add smaller node to merged list
             left = left->next; // move to next node in left
         } 
@@ -0,0 +1,132 @@
+// mmap.cpp
+// Overview: zero-copy input path - the input file is mapped into memory,
+// each line is kept as an (offset, length) view into the mapping, and the
+// sorted lines are written straight from the mapping with writev
+
+#include "volsort.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+struct LineView {
+    size_t      offset;     // start of the line in the mapping
+    size_t      length;     // bytes, not counting the newline
+    long long   number;     // numeric key, 0 when the line is not all digits
+};
+
+// Prototypes
+
+bool write_views(const char *base, const std::vector<LineView> &lines);
+
+// Implementations
+
+int mmap_sort(const char *path, bool numeric) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "volsort: " << path << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        std::cerr << "volsort: " << path << ": " << strerror(errno) << std::endl;
+        close(fd);
+        return 1;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "volsort: " << path << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+    // the split reads the file front to back once, but sorting and writing
+    // visit lines in key order, so read-ahead only helps the first pass
+    madvise(map, size, MADV_SEQUENTIAL);
+    const char *base = static_cast<const char *>(map);
+
+    // split into views; a missing final newline still ends the last line
+    std::vector<LineView> lines;
+    size_t start = 0;
+    while (start < size) {
+        const char *nl = static_cast<const char *>(memchr(base + start, '\n', size - start));
+        size_t end = nl ? nl - base : size;
+
+        // same rule as List::push_front: only all-digit lines get a value
+        LineView line = {start, end - start, parse_number(base + start, end - start)};
+        lines.push_back(line);
+        start = end + 1;
+    }
+    madvise(map, size, MADV_NORMAL);
+
+    if (numeric) {
+        std::stable_sort(lines.begin(), lines.end(), [](const LineView &a, const LineView &b) {
+            return a.number < b.number;
+        });
+    } else {
+        std::sort(lines.begin(), lines.end(), [base](const LineView &a, const LineView &b) {
+            int cmp = memcmp(base + a.offset, base + b.offset, std::min(a.length, b.length));
+            return cmp < 0 || (cmp == 0 && a.length < b.length);
+        });
+    }
+
+    bool ok = write_views(base, lines);
+    munmap(map, size);
+    return ok ? 0 : 1;
+}
+
+// writes every line followed by a newline, IOV_MAX / 2 lines per syscall
+bool write_views(const char *base, const std::vector<LineView> &lines) {
+    static char newline = '\n';
+    std::vector<struct iovec> iov;
+    iov.reserve(IOV_MAX);
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        iov.push_back({const_cast<char *>(base + lines[i].offset), lines[i].length});
+        iov.push_back({&newline, 1});
+        if (iov.size() + 2 > IOV_MAX || i + 1 == lines.size()) {
+            // writev may stop short, so pick up where it left off
+            struct iovec *curr = iov.data();
+            int left = iov.size();
+            while (left > 0) {
+                ssize_t n = writev(STDOUT_FILENO, curr, left);
+                if (n < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                while (left > 0 && (size_t)n >= curr->iov_len) {
+                    n -= curr->iov_len;
+                    curr++;
+                    left--;
+                }
+                if (left > 0) {
+                    curr->iov_base = static_cast<char *>(curr->iov_base) + n;
+                    curr->iov_len -= n;
+                }
+            }
+            iov.clear();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,127 @@
+// oblivious.cpp
+// Overview: data-oblivious sorting - a bitonic sorting network over an
+// array padded to a power of two. The sequence of compare-exchanges depends
+// only on the input size, never on the keys, and every compare-exchange is
+// branchless. For numeric keys the network runs over flat key/index arrays
+// whose inner loops are plain min/max selects the compiler can vectorize.
+
+#include "volsort.h"
+
+#include <climits>
+#include <vector>
+
+// Prototypes
+
+void bitonic_numbers(std::vector<long long> &keys, std::vector<size_t> &index);
+void bitonic_strings(std::vector<Node *> &nodes);
+
+// Implementations
+
+void oblivious_sort(List &l, bool numeric) {
+    if (l.size < 2) {
+        return;
+    }
+
+    // the network only works on powers of two
+    size_t padded = 1;
+    while (padded < l.size) {
+        padded <<= 1;
+    }
+
+    std::vector<Node *> nodes;
+    nodes.reserve(padded);
+    for (Node *curr = l.head; curr != nullptr; curr = curr->next) {
+        nodes.push_back(curr);
+    }
+
+    std::vector<Node *> sorted;
+    sorted.reserve(l.size);
+    if (numeric) {
+        // padding carries the largest key and an index past the real nodes
+        std::vector<long long> keys(padded, LLONG_MAX);
+        std::vector<size_t> index(padded);
+        for (size_t i = 0; i < padded; i++) {
+            index[i] = i;
+            if (i < l.size) {
+                keys[i] = nodes[i]->number;
+            }
+        }
+        bitonic_numbers(keys, index);
+        // padding may sit among real LLONG_MAX keys, so drop it by index
+        for (size_t i = 0; i < padded; i++) {
+            if (index[i] < l.size) {
+                sorted.push_back(nodes[index[i]]);
+            }
+        }
+    } else {
+        // nullptr padding sorts after every real node
+        nodes.resize(padded, nullptr);
+        bitonic_strings(nodes);
+        sorted.assign(nodes.begin(), nodes.begin() + l.size);
+    }
+
+    // relink the list in sorted order
+    for (size_t i = 0; i + 1 < sorted.size(); i++) {
+        sorted[i]->next = sorted[i + 1];
+    }
+    sorted.back()->next = nullptr;
+    l.head = sorted[0];
+}
+
+// stage k merges bitonic runs of length k; pass j compares elements j apart.
+// Each block of 2j splits into two contiguous halves, so the inner loop is a
+// straight-line min/max over j lanes.
+void bitonic_numbers(std::vector<long long> &keys, std::vector<size_t> &index) {
+    size_t n = keys.size();
+    long long *key = keys.data();
+    size_t *idx = index.data();
+
+    for (size_t k = 2; k <= n; k <<= 1) {
+        for (size_t j = k >> 1; j > 0; j >>= 1) {
+            for (size_t base = 0; base < n; base += 2 * j) {
+                // blocks inside an ascending run of length k sort up
+                bool ascending = (base & k) == 0;
+                long long *lo_key = key + base;
+                long long *hi_key = key + base + j;
+                size_t *lo_idx = idx + base;
+                size_t *hi_idx = idx + base + j;
+                for (size_t i = 0; i < j; i++) {
+                    long long a = lo_key[i];
+                    long long b = hi_key[i];
+                    size_t ia = lo_idx[i];
+                    size_t ib = hi_idx[i];
+                    bool swap = (a > b) == ascending;
+                    lo_key[i] = swap ? b : a;
+                    hi_key[i] = swap ? a : b;
+                    lo_idx[i] = swap ? ib : ia;
+                    hi_idx[i] = swap ? ia : ib;
+                }
+            }
+            // every pass is n / 2 compare-exchanges, whatever the keys
+            COUNT_COMPARISONS(n / 2);
+        }
+    }
+}
+
+// same network over node pointers, ordered by string_order
+void bitonic_strings(std::vector<Node *> &nodes) {
+    size_t n = nodes.size();
+    Node **node = nodes.data();
+
+    for (size_t k = 2; k <= n; k <<= 1) {
+        for (size_t j = k >> 1; j > 0; j >>= 1) {
+            for (size_t base = 0; base < n; base += 2 * j) {
+                bool ascending = (base & k) == 0;
+                for (size_t i = base; i < base + j; i++) {
+                    Node *a = node[i];
+                    Node *b = node[i + j];
+                    // padding (nullptr) is greater than any real node
+                    bool greater = a ? (b && string_order(a, b) > 0) : b != nullptr;
+                    bool swap = greater == ascending;
+                    node[i]     = swap ? b : a;
+                    node[i + j] = swap ? a : b;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,122 @@
+// pmerge.cpp
+// Overview: parallel merge sort - the list is cut into one run per thread,
+// each run is sorted with msort on its own worker, and the sorted runs are
+// combined with a k-way merge driven by a loser tree
+
+#include "volsort.h"
+
+#include <thread>
+#include <vector>
+
+// From merge.cpp
+Node *msort(Node *head, bool numeric);
+
+// Prototypes
+
+bool  node_less(const Node *a, const Node *b, bool numeric);
+Node *kway_merge(std::vector<Node *> &runs, bool numeric);
+
+// Implementations
+
+void pmerge_sort(List &l, bool numeric, size_t threads) {
+    if (l.size < 2) {
+        return;
+    }
+    if (threads < 1) {
+        threads = 1;
+    }
+    if (threads > l.size) {
+        threads = l.size;
+    }
+
+    // cut the list into runs of (nearly) equal length
+    std::vector<Node *> runs(threads);
+    Node *curr = l.head;
+    for (size_t r = 0; r < threads; r++) {
+        size_t length = l.size / threads + (r < l.size % threads ? 1 : 0);
+        runs[r] = curr;
+        for (size_t i = 1; i < length; i++) {
+            curr = curr->next;
+        }
+        Node *next = curr->next;
+        curr->next = nullptr;
+        curr = next;
+    }
+
+    // sort each run on its own thread; the runs share no nodes
+    std::vector<std::thread> workers;
+    for (size_t r = 1; r < threads; r++) {
+        workers.emplace_back([&runs, r, numeric]() {
+            runs[r] = msort(runs[r], numeric);
+        });
+    }
+    runs[0] = msort(runs[0], numeric);
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    l.head = kway_merge(runs, numeric);
+}
+
+// ordering used by the merge; an exhausted run (nullptr) loses to everything
+bool node_less(const Node *a, const Node *b, bool numeric) {
+    if (!b) {
+        return a != nullptr;
+    }
+    if (!a) {
+        return false;
+    }
+    return (numeric ? number_order(a, b) : string_order(a, b)) < 0;
+}
+
+// merges k sorted runs with a loser tree: each internal node remembers the
+// run that lost the match played there, so replacing the winner only replays
+// the log2(k) matches on its path to the root
+Node *kway_merge(std::vector<Node *> &runs, bool numeric) {
+    size_t k = runs.size();
+    if (k == 1) {
+        return runs[0];
+    }
+
+    // leaves live at k..2k-1, internal nodes at 1..k-1, overall winner in tree[0]
+    std::vector<size_t> tree(k);
+    std::vector<size_t> winner(2 * k);
+    for (size_t r = 0; r < k; r++) {
+        winner[k + r] = r;
+    }
+    for (size_t i = k - 1; i > 0; i--) {
+        size_t a = winner[2 * i];
+        size_t b = winner[2 * i + 1];
+        // ties go to the lower run so equal keys keep their order
+        bool a_wins = node_less(runs[a], runs[b], numeric) ||
+                      (!node_less(runs[b], runs[a], numeric) && a < b);
+        winner[i] = a_wins ? a : b;
+        tree[i]   = a_wins ? b : a;
+    }
+    tree[0] = winner[1];
+
+    Node head;
+    Node *tail = &head;
+    while (runs[tree[0]]) {
+        size_t r = tree[0];
+        tail->next = runs[r];
+        tail = tail->next;
+        runs[r] = runs[r]->next;
+
+        // replay matches from the leaf of run r up to the root
+        size_t champion = r;
+        for (size_t i = (k + r) / 2; i > 0; i /= 2) {
+            size_t loser = tree[i];
+            bool loser_wins = node_less(runs[loser], runs[champion], numeric) ||
+                              (!node_less(runs[champion], runs[loser], numeric) && loser < champion);
+            if (loser_wins) {
+                tree[i] = champion;
+                champion = loser;
+            }
+        }
+        tree[0] = champion;
+    }
+    tail->next = nullptr;
+
+    return head.next;
+}
@@ -11,7 +11,7 @@ int compare_strings(const void *a, const void *b)
     // Assign to node pointers
     const Node *nb = *(const Node **)b;
     // Compares em
-    return na->string.compare(nb->string);
+    return string_order(na, nb);
 }
 
 int compare_numbers(const void *a, const void *b)
@@ -19,8 +19,8 @@ int compare_numbers(const void *a, const void *b)
     const Node *na = *(const Node **)a;
     // Assign to node pointers
     const Node *nb = *(const Node **)b;
-    // Determine order
-    return na->number - nb->number;
+    // Determine order (no subtraction, 64-bit values would overflow it)
+    return number_order(na, nb);
 }
 void qsort_sort(List &l, bool numeric)
 {
@@ -2,18 +2,35 @@
 // ncash3
 // Description: recursively sorts a list
 // using partition, concatenate, and qsort
-// functions
+// functions. Pivots are median-of-three samples,
+// partitioning is three-way (<, =, >), every
+// sublist tracks its tail so concatenation is
+// O(1), and past a depth limit we hand the
+// sublist to merge sort instead.
 // quick.cpp
 
 #include "volsort.h"
 
 #include <iostream>
 
+// A sublist with its tail and length tracked so joining lists never walks them
+struct Span {
+	Node   *head;
+	Node   *tail;
+	size_t  size;
+};
+
 // Prototypes
 
-Node *qsort(Node *head, bool numeric);
-void  partition(Node *head, Node *pivot, Node *&left, Node *&right, bool numeric);
-Node *concatenate(Node *left, Node *right);
+Span  qsort(Span list, bool numeric, int depth);
+Node *median_of_three(Span list, bool numeric);
+void  partition(Span list, Node *pivot, Span &left, Span &equal, Span &right, bool numeric);
+Span  concatenate(Span left, Span right);
+int   compare(const Node *a, const Node *b, bool numeric);
+void  append(Span &list, Node *node);
+
+// From merge.cpp
+Node *msort(Node *head, bool numeric);
 
 // Implementations
 
@@ -22,88 +39,135 @@ void quick_sort(List &l, bool numeric) {
 	if (l.size == 0){
 		return;
 	}
-	l.head = qsort(l.head, numeric);
+
+	Span list = {l.head, l.head, 0};
+	for (Node *curr = l.head; curr; curr = curr->next){
+		list.tail = curr;
+		list.size++;
+	}
+
+	// depth limit of 2 * log2(n), same as introsort
+	int depth = 0;
+	for (size_t n = list.size; n > 1; n >>= 1){
+		depth += 2;
+	}
+
+	l.head = qsort(list, numeric, depth).head;
 }
 
-Node *qsort(Node *head, bool numeric) {
-	
+Span qsort(Span list, bool numeric, int depth) {
 
 	// base case : check if list is empty or one element
-	if((!head) || (!head->next)){
-		return head;
+	if (list.size < 2){
+		return list;
 	}
 
-	// make the pivot at the head
-	Node *pivot = head;
+	// too many bad pivots in a row, merge sort is O(n log n) no matter what
+	if (depth == 0){
+		list.head = msort(list.head, numeric);
+		for (list.tail = list.head; list.tail->next; list.tail = list.tail->next){
+		}
+		return list;
+	}
 
-	Node *left = nullptr;
-	Node *right = nullptr;
+	// pick the pivot from a sample so sorted input doesn't go quadratic
+	Node *pivot = median_of_three(list, numeric);
 
-	// parition around the pivot
-	partition(head->next, pivot, left, right, numeric);
+	Span left  = {nullptr, nullptr, 0};
+	Span equal = {nullptr, nullptr, 0};
+	Span right = {nullptr, nullptr, 0};
 
-	// recursively sort left and right subparts
-	if (left){
-		left = qsort(left, numeric);
-	}
-	if (right){
-		right = qsort(right, numeric);
-	}
-	
-	// concatenate pivot w/ right list
-//	Node *temp = concatenate(pivot, right);
-	pivot->next = right;	
-	// concatenate the left list w/ the right
-	return concatenate(left, pivot);
+	// partition around the pivot
+	partition(list, pivot, left, equal, right, numeric);
 
+	// recursively sort left and right subparts; the equal part is already done,
+	// so runs of duplicates drop out after one pass
+	left  = qsort(left, numeric, depth - 1);
+	right = qsort(right, numeric, depth - 1);
 
+	// concatenate the left list w/ the equal list w/ the right
+	return concatenate(concatenate(left, equal), right);
 }
 
-void partition(Node *head, Node *pivot, Node *&left, Node *&right, bool numeric) {
+// median of the first, middle and last nodes
+Node *median_of_three(Span list, bool numeric) {
+	Node *a = list.head;
+	Node *b = list.head;
+	Node *c = list.tail;
+	for (size_t i = 0; i < list.size / 2; i++){
+		b = b->next;
+	}
 
+	if (compare(a, b, numeric) > 0){
+		std::swap(a, b);
+	}
+	if (compare(b, c, numeric) > 0){
+		std::swap(b, c);
+	}
+	if (compare(a, b, numeric) > 0){
+		std::swap(a, b);
+	}
+	return b;
+}
+
+void partition(Span list, Node *pivot, Span &left, Span &equal, Span &right, bool numeric) {
+
+	Node *head = list.head;
 	while(head){
-		
-		bool lessThan = false;
-		
-		// determines if value is less than pivot or not
-		if (numeric) { // for numbers
-			lessThan = (head->number) < (pivot->number);
-		} else { // for letters
-			lessThan = head->string.compare(pivot->string) < 0;
-		}
 
 		// store current node and move pointer over
 		Node *temp = head;
 		head = head->next;
-		
-		// assigns node to either left or right
-		// depending if its less or greater than pivot
-		if (lessThan) {
-			temp->next = left;  
-			left = temp;
+
+		// assigns node to left, equal, or right
+		// depending how it compares to the pivot
+		int order = compare(temp, pivot, numeric);
+		if (order < 0) {
+			append(left, temp);
+		} else if (order == 0) {
+			append(equal, temp);
 		} else {
-			temp->next = right; 
-			right = temp;
+			append(right, temp);
 		}
-		
+
 	}
 }
 
-Node *concatenate(Node *left, Node *right) {
-	
-	// for when left node is empty
-	if(!left){
+Span concatenate(Span left, Span right) {
+
+	// for when either side is empty
+	if(!left.head){
 		return right;
 	}
-
-	// go to the end of the left list
-	Node *temp = left;
-	while (temp->next){
-		temp = temp->next;
+	if(!right.head){
+		return left;
 	}
 
-	// the concatenation
-	temp->next = right;
+	// the concatenation, no walking thanks to the tail
+	left.tail->next = right.head;
+	left.tail = right.tail;
+	left.size += right.size;
 	return left;
 
 }
+
+// determines if value is less than (< 0), equal to (0), or greater than (> 0)
+int compare(const Node *a, const Node *b, bool numeric) {
+	if (numeric) { // for numbers
+		return number_order(a, b);
+	}
+	// for letters
+	return string_order(a, b);
+}
+
+// adds node to the end of list
+void append(Span &list, Node *node) {
+	node->next = nullptr;
+	if (list.tail){
+		list.tail->next = node;
+	} else {
+		list.head = node;
+	}
+	list.tail = node;
+	list.size++;
+}
@@ -0,0 +1,184 @@
+// radix.cpp
+// Overview: non-comparison sorting - LSD radix over the numeric key and
+// MSD radix over the string key, with insertion sort for small buckets
+
+#include "volsort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Buckets smaller than this are finished off with insertion sort
+const size_t RADIX_CUTOFF = 32;
+
+// Buckets whose strings still agree this deep are finished off by comparison
+// instead of one counting pass per shared byte
+const size_t RADIX_MAX_DEPTH = 64;
+
+// Prototypes
+
+void lsd_radix(std::vector<Node *> &nodes);
+void msd_radix(Node **nodes, Node **aux, size_t n, size_t depth);
+void insertion_sort(Node **nodes, size_t n, size_t depth);
+void compare_sort(Node **nodes, size_t n, size_t depth);
+int  char_at(const Node *node, size_t depth);
+
+// Implementations
+
+void radix_sort(List &l, bool numeric) {
+    if (l.size == 0) {
+        return;
+    }
+
+    // copy the list into an array so we can scatter pointers around
+    std::vector<Node *> nodes;
+    nodes.reserve(l.size);
+    for (Node *curr = l.head; curr != nullptr; curr = curr->next) {
+        nodes.push_back(curr);
+    }
+
+    if (numeric) {
+        lsd_radix(nodes);
+    } else {
+        std::vector<Node *> aux(nodes.size());
+        msd_radix(nodes.data(), aux.data(), nodes.size(), 0);
+    }
+
+    // relink the list in sorted order
+    for (size_t i = 0; i + 1 < nodes.size(); i++) {
+        nodes[i]->next = nodes[i + 1];
+    }
+    nodes.back()->next = nullptr;
+    l.head = nodes[0];
+}
+
+// one stable counting pass per byte, least significant first
+void lsd_radix(std::vector<Node *> &nodes) {
+    typedef decltype(Node::number) key_t;
+    const size_t bytes = sizeof(key_t);
+    // flipping the sign bit makes negative numbers order before positive ones
+    const unsigned long long sign = 1ULL << (bytes * 8 - 1);
+
+    std::vector<Node *> aux(nodes.size());
+    for (size_t pass = 0; pass < bytes; pass++) {
+        size_t count[257] = {0};
+        size_t shift = pass * 8;
+
+        for (Node *node : nodes) {
+            unsigned long long key = (unsigned long long)node->number ^ sign;
+            count[((key >> shift) & 0xff) + 1]++;
+        }
+
+        // all keys share this byte, nothing would move
+        bool skip = false;
+        for (int b = 1; b <= 256; b++) {
+            if (count[b] == nodes.size()) {
+                skip = true;
+            }
+        }
+        if (skip) {
+            continue;
+        }
+
+        for (int b = 0; b < 256; b++) {
+            count[b + 1] += count[b];
+        }
+        for (Node *node : nodes) {
+            unsigned long long key = (unsigned long long)node->number ^ sign;
+            aux[count[(key >> shift) & 0xff]++] = node;
+        }
+        nodes.swap(aux);
+    }
+}
+
+// byte at depth, or -1 once we run off the end (shorter strings go first)
+int char_at(const Node *node, size_t depth) {
+    if (depth < node->string.size()) {
+        return (unsigned char)node->string[depth];
+    }
+    return -1;
+}
+
+// sorts strings that already agree on their first depth bytes
+void insertion_sort(Node **nodes, size_t n, size_t depth) {
+    for (size_t i = 1; i < n; i++) {
+        Node *curr = nodes[i];
+        size_t j = i;
+        while (j > 0 && nodes[j - 1]->string.compare(depth, std::string::npos,
+                                                     curr->string, depth, std::string::npos) > 0) {
+            nodes[j] = nodes[j - 1];
+            j--;
+        }
+        nodes[j] = curr;
+    }
+}
+
+// sorts strings that already agree on their first depth bytes, by comparison
+void compare_sort(Node **nodes, size_t n, size_t depth) {
+    std::sort(nodes, nodes + n, [depth](const Node *a, const Node *b) {
+        return a->string.compare(depth, std::string::npos, b->string, depth, std::string::npos) < 0;
+    });
+}
+
+// bucket on the byte at depth, then do the same to each bucket on the next
+// byte; pending buckets go on an explicit stack, so a long shared prefix
+// can't run the call stack out
+void msd_radix(Node **nodes, Node **aux, size_t n, size_t depth) {
+    struct Bucket {
+        size_t lo, n, depth;
+    };
+    std::vector<Bucket> work;
+    work.push_back({0, n, depth});
+
+    while (!work.empty()) {
+        Bucket bucket = work.back();
+        work.pop_back();
+        Node **base = nodes + bucket.lo;
+        size_t size = bucket.n;
+        size_t at = bucket.depth;
+
+        // slot 0 is for strings that ended, 1..256 for each byte value
+        size_t count[258];
+        while (size >= RADIX_CUTOFF && at < RADIX_MAX_DEPTH) {
+            std::memset(count, 0, sizeof(count));
+            for (size_t i = 0; i < size; i++) {
+                count[char_at(base[i], at) + 2]++;
+            }
+            // every string has the same byte here: step past it in place
+            if (count[1] == 0 && std::count(count + 2, count + 258, size) == 1) {
+                at++;
+                continue;
+            }
+            break;
+        }
+        if (size < RADIX_CUTOFF) {
+            insertion_sort(base, size, at);
+            continue;
+        }
+        if (at >= RADIX_MAX_DEPTH) {
+            compare_sort(base, size, at);
+            continue;
+        }
+
+        for (int b = 0; b < 257; b++) {
+            count[b + 1] += count[b];
+        }
+
+        // count[b] is now where bucket b - 1 starts; keep the starts for the buckets
+        size_t start[258];
+        std::memcpy(start, count, sizeof(start));
+        for (size_t i = 0; i < size; i++) {
+            aux[count[char_at(base[i], at) + 1]++] = base[i];
+        }
+        std::memcpy(base, aux, size * sizeof(Node *));
+
+        // strings that ended are all equal, so only the byte buckets need more work
+        for (int b = 1; b < 257; b++) {
+            size_t lo = start[b];
+            size_t hi = start[b + 1];
+            if (hi - lo > 1) {
+                work.push_back({bucket.lo + lo, hi - lo, at + 1});
+            }
+        }
+    }
+}
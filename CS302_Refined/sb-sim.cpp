@@ -0,0 +1,253 @@
+// sb-sim.cpp
+// Overview: headless Superball driver. Plays many games in-process on the
+// standard 8x10 board (goals in rows 2-5 of the two outer columns on each
+// side, minimum set 5, colors pbyrg), calling Player::choose() directly
+// instead of going through sb-play's stdin/stdout. Tiles spawn from a
+// per-game seed, so the same seed replays the same games on any number of
+// threads. Reports average score, moves per second and a histogram of
+// how long each move took to choose. -c instead plays a few fixed
+// positions with a known right answer and exits non-zero on a wrong one.
+//
+//   g++ -O2 -pthread -o sb-sim sb-sim.cpp superball.cpp
+//   ./sb-sim -n 1000 -d 1            # greedy
+//   ./sb-sim -n 100 -d 2 -b 0.05     # two-ply lookahead, 50 ms a move
+//   ./sb-sim -c                      # regression positions
+
+#include "superball.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+const int ROWS = 8;
+const int COLS = 10;
+const int MIN_SET = 5;
+const char *COLORS = "pbyrg";
+
+// Move latency buckets: bucket b holds moves under 2^b microseconds
+const int BUCKETS = 32;
+
+struct Stats {
+    long long   games = 0;
+    long long   score = 0;
+    long long   moves = 0;
+    int         best = 0;
+    int         worst = -1;
+    long long   latency[BUCKETS] = {};
+
+    void add(const Stats &other) {
+        games += other.games;
+        score += other.score;
+        moves += other.moves;
+        best = std::max(best, other.best);
+        if (other.worst != -1 && (worst == -1 || other.worst < worst)) {
+            worst = other.worst;
+        }
+        for (int b = 0; b < BUCKETS; b++) {
+            latency[b] += other.latency[b];
+        }
+    }
+};
+
+struct Config {
+    long long       games;
+    uint64_t        seed;
+    SearchOptions   search;
+};
+
+// Point value of each color letter, as sb-play assigns them
+std::vector<int> colorValues() {
+    std::vector<int> color(256, 0);
+    for (int i = 0; COLORS[i]; i++) {
+        color[(unsigned char)COLORS[i]] = 2 + i;
+    }
+    return color;
+}
+
+std::vector<int> goalCells() {
+    std::vector<int> goals(ROWS * COLS, 0);
+    for (int r = 2; r <= 5; r++) {
+        goals[r * COLS] = goals[r * COLS + 1] = 1;
+        goals[r * COLS + COLS - 2] = goals[r * COLS + COLS - 1] = 1;
+    }
+    return goals;
+}
+
+// Plays game number game to the end and returns its score
+int play(const Config &config, long long game, Stats &stats) {
+    Board board(ROWS, COLS, MIN_SET, colorValues());
+    board.load(std::vector<int>(ROWS * COLS, '.'), goalCells());
+
+    // spawns and the player's own sampling draw from separate streams
+    uint64_t spawns = mix(config.seed ^ mix(game));
+    SearchOptions options = config.search;
+    options.seed = mix(spawns);
+    Player<Board> player(options);
+
+    spawnTiles(board, options.swapSpawn, spawns);
+    int score = 0;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        Move move = player.choose(board);
+        auto stop = std::chrono::steady_clock::now();
+
+        long long us = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count();
+        int bucket = 0;
+        while (bucket < BUCKETS - 1 && us >= (1LL << bucket)) {
+            bucket++;
+        }
+        stats.latency[bucket]++;
+
+        if (move.a == -1) {
+            break;
+        }
+        stats.moves++;
+
+        if (move.score) {
+            score += board.score(move.a);
+            spawnTiles(board, options.scoreSpawn, spawns);
+        } else {
+            board.swapCells(move.a, move.b);
+            if (board.empties() < options.swapSpawn) {
+                break;
+            }
+            spawnTiles(board, options.swapSpawn, spawns);
+        }
+    }
+    return score;
+}
+
+// Claims games off the shared counter until they run out
+void worker(const Config &config, std::atomic<long long> &next, Stats &stats) {
+    long long game;
+    while ((game = next.fetch_add(1)) < config.games) {
+        int score = play(config, game, stats);
+        stats.games++;
+        stats.score += score;
+        stats.best = std::max(stats.best, score);
+        if (stats.worst == -1 || score < stats.worst) {
+            stats.worst = score;
+        }
+    }
+}
+
+// Fixed positions with one right move, tried at every depth. The first
+// is a full board with a single empty cell: the 5-tile p set on the goal
+// in row 5 must be scored, since any swap leaves too few empties for the
+// spawn and ends the game with those points still on the board.
+int check(const SearchOptions &base) {
+    std::vector<int> cells(ROWS * COLS);
+    for (int r = 0; r < ROWS; r++) {
+        for (int c = 0; c < COLS; c++) {
+            // no two neighbors match, so the p set is the only group
+            cells[r * COLS + c] = "byrg"[(r + 2 * c) % 4];
+        }
+    }
+    for (int c = 0; c < 5; c++) {
+        cells[5 * COLS + c] = 'p';
+    }
+    cells[ROWS * COLS - 1] = '.';
+
+    int failures = 0;
+    for (int depth = 1; depth <= 3; depth++) {
+        Board board(ROWS, COLS, MIN_SET, colorValues());
+        board.load(cells, goalCells());
+
+        SearchOptions options = base;
+        options.depth = depth;
+        options.budget = 60;
+        options.seed = 1;
+        Player<Board> player(options);
+        Move move = player.choose(board);
+
+        bool right = move.score && move.a == 5 * COLS + 1;
+        printf("full board, depth %d: %s %d %d  %s\n", depth, move.score ? "SCORE" : "SWAP",
+               move.a, move.b, right ? "ok" : "WRONG, expected SCORE 51");
+        failures += !right;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+void usage(const char *program) {
+    fprintf(stderr, "usage: %s [-n games] [-j threads] [-s seed] [-d depth] [-w beam]\n"
+                    "       [-S samples] [-b budget-seconds] [-x swap-spawn] [-y score-spawn] [-c]\n", program);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    Config config;
+    config.games = 1000;
+    config.seed = 1;
+    config.search = SearchOptions{1, 6, 3, 5, 3, 0.5, 0};
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    bool checking = false;
+
+    int c;
+    while ((c = getopt(argc, argv, "n:j:s:d:w:S:b:x:y:ch")) != -1) {
+        switch (c) {
+            case 'n': config.games = atoll(optarg); break;
+            case 'j': threads = atoi(optarg); break;
+            case 's': config.seed = strtoull(optarg, nullptr, 10); break;
+            case 'd': config.search.depth = atoi(optarg); break;
+            case 'w': config.search.beam = atoi(optarg); break;
+            case 'S': config.search.samples = atoi(optarg); break;
+            case 'b': config.search.budget = atof(optarg); break;
+            case 'x': config.search.swapSpawn = atoi(optarg); break;
+            case 'y': config.search.scoreSpawn = atoi(optarg); break;
+            case 'c': checking = true; break;
+            default:  usage(argv[0]);
+        }
+    }
+    if (config.games <= 0 || threads <= 0 || config.search.depth <= 0 || config.search.beam <= 0 ||
+        config.search.samples <= 0 || config.search.swapSpawn <= 0 || config.search.scoreSpawn < 0) {
+        usage(argv[0]);
+    }
+    if (checking) {
+        return check(config.search);
+    }
+
+    std::atomic<long long> next(0);
+    std::vector<Stats> stats(threads);
+    std::vector<std::thread> workers;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.push_back(std::thread(worker, std::cref(config), std::ref(next), std::ref(stats[t])));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Stats total;
+    for (int t = 0; t < threads; t++) {
+        total.add(stats[t]);
+    }
+
+    printf("games      %lld on %d threads, seed %llu, depth %d\n",
+           total.games, threads, (unsigned long long)config.seed, config.search.depth);
+    printf("score      avg %.2f  min %d  max %d\n", (double)total.score / total.games, total.worst, total.best);
+    printf("moves      %lld  (%.1f per game)\n", total.moves, (double)total.moves / total.games);
+    printf("throughput %.1f moves/s  %.2f games/s  %.2f s wall\n",
+           total.moves / seconds, total.games / seconds, seconds);
+
+    long long calls = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        calls += total.latency[b];
+    }
+    printf("latency per choose()\n");
+    for (int b = 0; b < BUCKETS; b++) {
+        if (total.latency[b] != 0) {
+            printf("  < %10lld us  %10lld  %5.1f%%\n", 1LL << b, total.latency[b],
+                   100.0 * total.latency[b] / calls);
+        }
+    }
+
+    return 0;
+}
@@ -8,11 +8,11 @@ using namespace std;
 
 // C++ style comparison functions
 bool node_string_compare(const Node *a, const Node *b) {
-    return a->string < b->string; // true if string is in correct order (ascending)
+    return string_order(a, b) < 0; // true if string is in correct order (ascending)
 }
 // C++ style comparisons functions
 bool node_number_compare(const Node *a, const Node *b) {
-    return a->number < b->number; // true if number is in correct order (ascending)
+    return number_order(a, b) < 0; // true if number is in correct order (ascending)
 }
 // void stl function
 void stl_sort(List &l, bool numeric) {
@@ -0,0 +1,740 @@
+// superball.cpp
+// Overview: incremental group labeling for the Superball board. Groups
+// can split when a cell changes, so instead of a union-find (which can
+// only merge) each change relabels just the group the cell left and the
+// groups it now joins, logging every write so it can be undone. BitBoard
+// is the other backend: no labels at all, just a bitboard per color that
+// is flood filled on demand.
+
+#include "superball.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+Board::Board(int rows, int cols, int min, const std::vector<int> &color)
+    : rows(rows), cols(cols), min(min), color(color) {
+    cell.assign(rows * cols, '.');
+    goal.assign(rows * cols, 0);
+    label.assign(rows * cols, -1);
+    seen.assign(rows * cols, 0);
+    zobrist.resize(rows * cols * 26);
+    for (size_t i = 0; i < zobrist.size(); i++) {
+        zobrist[i] = mix(i);
+    }
+    hash = 0;
+    empty = rows * cols;
+}
+
+void Board::load(const std::vector<int> &cells, const std::vector<int> &goals) {
+    hash = 0;
+    empty = 0;
+    for (int i = 0; i < rows * cols; i++) {
+        cell[i] = cells[i];
+        goal[i] = goals[i] != 0;
+        label[i] = -1;
+        hash ^= key(i, cell[i]);
+        empty += cell[i] == '.';
+    }
+    groups.clear();
+    freeIds.clear();
+
+    // label every group from scratch; nothing before this can be undone
+    for (int i = 0; i < rows * cols; i++) {
+        if (cell[i] != '.' && label[i] == -1) {
+            fill(i);
+        }
+    }
+    log.clear();
+}
+
+int Board::neighbors(int index, int out[4]) const {
+    int row = index / cols;
+    int col = index % cols;
+    int count = 0;
+    if (row > 0)        out[count++] = index - cols;
+    if (col < cols - 1) out[count++] = index + 1;
+    if (row < rows - 1) out[count++] = index + cols;
+    if (col > 0)        out[count++] = index - 1;
+    return count;
+}
+
+uint64_t Board::key(int index, char value) const {
+    return value == '.' ? 0 : zobrist[index * 26 + value - 'a'];
+}
+
+// Logged writes -----------------------------------------------------------------
+
+void Board::setCell(int index, char value) {
+    log.push_back({LOG_CELL, index, cell[index], Group()});
+    hash ^= key(index, cell[index]) ^ key(index, value);
+    empty += (value == '.') - (cell[index] == '.');
+    cell[index] = value;
+}
+
+void Board::setLabel(int index, int id) {
+    log.push_back({LOG_LABEL, index, label[index], Group()});
+    label[index] = id;
+}
+
+void Board::setGroup(int id, const Group &group) {
+    log.push_back({LOG_GROUP, id, 0, groups[id]});
+    groups[id] = group;
+}
+
+void Board::retire(int id) {
+    setGroup(id, Group{0, 0, -1, '.'});
+    freeIds.push_back(id);
+    log.push_back({LOG_FREE_PUSH, id, 0, Group()});
+}
+
+int Board::allocate() {
+    if (!freeIds.empty()) {
+        int id = freeIds.back();
+        freeIds.pop_back();
+        log.push_back({LOG_FREE_POP, id, 0, Group()});
+        return id;
+    }
+    groups.push_back(Group{0, 0, -1, '.'});
+    log.push_back({LOG_NEW_GROUP, (int)groups.size() - 1, 0, Group()});
+    return groups.size() - 1;
+}
+
+// Labeling ----------------------------------------------------------------------
+
+// every cell sharing index's label
+void Board::collect(int index, std::vector<int> &cells) {
+    int id = label[index];
+    cells.clear();
+    cells.push_back(index);
+    seen[index] = 1;
+    for (size_t head = 0; head < cells.size(); head++) {
+        int around[4];
+        int count = neighbors(cells[head], around);
+        for (int n = 0; n < count; n++) {
+            int next = around[n];
+            if (label[next] == id && !seen[next]) {
+                seen[next] = 1;
+                cells.push_back(next);
+            }
+        }
+    }
+    for (size_t i = 0; i < cells.size(); i++) {
+        seen[cells[i]] = 0;
+    }
+}
+
+// gives seed's whole same-colored region a fresh group, absorbing (and
+// retiring) any groups it runs into along the way
+void Board::fill(int seed) {
+    int id = allocate();
+    Group group = {0, 0, -1, cell[seed]};
+
+    pending.clear();
+    pending.push_back(seed);
+    setLabel(seed, id);
+    while (!pending.empty()) {
+        int current = pending.back();
+        pending.pop_back();
+
+        group.size++;
+        if (goal[current]) {
+            group.goalCells++;
+            if (current > group.scoringCell) {
+                group.scoringCell = current;
+            }
+        }
+
+        int around[4];
+        int count = neighbors(current, around);
+        for (int n = 0; n < count; n++) {
+            int next = around[n];
+            if (cell[next] != group.color || label[next] == id) {
+                continue;
+            }
+            if (label[next] != -1 && groups[label[next]].size > 0) {
+                retire(label[next]);
+            }
+            setLabel(next, id);
+            pending.push_back(next);
+        }
+    }
+    setGroup(id, group);
+}
+
+void Board::set(int index, char value) {
+    if (cell[index] == value) {
+        return;
+    }
+
+    // the group index leaves may fall apart, so its cells all get relabeled
+    std::vector<int> &seeds = members;
+    if (label[index] != -1) {
+        collect(index, seeds);
+        retire(label[index]);
+        for (size_t i = 0; i < seeds.size(); i++) {
+            setLabel(seeds[i], -1);
+        }
+    } else {
+        seeds.assign(1, index);
+    }
+
+    setCell(index, value);
+
+    for (size_t i = 0; i < seeds.size(); i++) {
+        if (cell[seeds[i]] != '.' && label[seeds[i]] == -1) {
+            fill(seeds[i]);
+        }
+    }
+}
+
+void Board::swapCells(int a, int b) {
+    char first = cell[a];
+    char second = cell[b];
+    if (first == second) {
+        return;
+    }
+    set(a, second);
+    set(b, first);
+}
+
+int Board::score(int index) {
+    if (label[index] == -1) {
+        return 0;
+    }
+    int id = label[index];
+    int points = groups[id].size * color[(unsigned char)groups[id].color];
+
+    // removing a whole group can't change any other group
+    std::vector<int> &cells = members;
+    collect(index, cells);
+    retire(id);
+    for (size_t i = 0; i < cells.size(); i++) {
+        setLabel(cells[i], -1);
+        setCell(cells[i], '.');
+    }
+    return points;
+}
+
+int Board::empties() const {
+    return empty;
+}
+
+// Undo --------------------------------------------------------------------------
+
+size_t Board::mark() const {
+    return log.size();
+}
+
+void Board::undo(size_t mark) {
+    while (log.size() > mark) {
+        const LogEntry &entry = log.back();
+        switch (entry.kind) {
+            case LOG_LABEL:     label[entry.index] = entry.value; break;
+            case LOG_CELL:
+                hash ^= key(entry.index, cell[entry.index]) ^ key(entry.index, entry.value);
+                empty += (entry.value == '.') - (cell[entry.index] == '.');
+                cell[entry.index] = entry.value;
+                break;
+            case LOG_GROUP:     groups[entry.index] = entry.group; break;
+            case LOG_NEW_GROUP: groups.pop_back(); break;
+            case LOG_FREE_PUSH: freeIds.pop_back(); break;
+            case LOG_FREE_POP:  freeIds.push_back(entry.index); break;
+        }
+        log.pop_back();
+    }
+}
+
+// Queries -----------------------------------------------------------------------
+
+int Board::groupSize(int index) const {
+    return label[index] == -1 ? 0 : groups[label[index]].size;
+}
+
+bool Board::groupTouchesGoal(int index) const {
+    return label[index] != -1 && groups[label[index]].goalCells > 0;
+}
+
+void Board::scoringSets(std::vector<ScoringSet> &sets) const {
+    sets.clear();
+    for (size_t id = 0; id < groups.size(); id++) {
+        const Group &group = groups[id];
+        if (group.size >= min && group.goalCells > 0) {
+            sets.push_back({group.size, group.color, group.scoringCell / cols, group.scoringCell % cols});
+        }
+    }
+}
+
+// BitBoard ----------------------------------------------------------------------
+
+BitBoard::BitBoard(int rows, int cols, int min, const std::vector<int> &color)
+    : rows(rows), cols(cols), min(min), color(color) {
+    plane.assign(256, -1);
+    for (int ch = 'a'; ch <= 'z'; ch++) {
+        if (color[ch] != 0) {
+            plane[ch] = letter.size();
+            letter.push_back(ch);
+        }
+    }
+    cell.assign(rows * cols, '.');
+    goal.assign(rows * cols, 0);
+    bits.assign(letter.size() * rows, 0);
+    goalBits.assign(rows, 0);
+    zobrist.resize(rows * cols * 26);
+    for (size_t i = 0; i < zobrist.size(); i++) {
+        zobrist[i] = mix(i);
+    }
+    hash = 0;
+    empty = rows * cols;
+}
+
+void BitBoard::load(const std::vector<int> &cells, const std::vector<int> &goals) {
+    std::fill(bits.begin(), bits.end(), 0);
+    std::fill(goalBits.begin(), goalBits.end(), 0);
+    hash = 0;
+    empty = 0;
+    for (int i = 0; i < rows * cols; i++) {
+        int row = i / cols;
+        uint64_t bit = 1ULL << (i % cols);
+        cell[i] = cells[i];
+        goal[i] = goals[i] != 0;
+        hash ^= key(i, cell[i]);
+        empty += cell[i] == '.';
+        if (cell[i] != '.') {
+            bits[plane[(unsigned char)cell[i]] * rows + row] |= bit;
+        }
+        if (goal[i]) {
+            goalBits[row] |= bit;
+        }
+    }
+    log.clear();
+}
+
+uint64_t BitBoard::key(int index, char value) const {
+    return value == '.' ? 0 : zobrist[index * 26 + value - 'a'];
+}
+
+void BitBoard::setCell(int index, char value) {
+    log.push_back({LOG_CELL, index, (uint64_t)(unsigned char)cell[index]});
+    hash ^= key(index, cell[index]) ^ key(index, value);
+    empty += (value == '.') - (cell[index] == '.');
+    cell[index] = value;
+}
+
+void BitBoard::setWord(int index, uint64_t value) {
+    log.push_back({LOG_WORD, index, bits[index]});
+    bits[index] = value;
+}
+
+// the runs of mask that x touches, filled out in both directions with
+// log-step (Kogge-Stone) shifts instead of one column per step
+static inline uint64_t spanFill(uint64_t x, uint64_t mask) {
+    uint64_t up = mask, down = mask;
+    uint64_t high = x, low = x;
+    for (int shift = 1; shift < 64; shift <<= 1) {
+        high |= up & (high << shift);
+        up &= up << shift;
+        low |= down & (low >> shift);
+        down &= down >> shift;
+    }
+    return high | low;
+}
+
+// grows region (rows words) over plane p until it stops changing: each
+// row is closed sideways in one spanFill, then the result is passed down
+// and back up the rows, so a group needs only a couple of sweeps
+void BitBoard::flood(int p, uint64_t *region) const {
+    const uint64_t *mask = &bits[p * rows];
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int r = 0; r < rows; r++) {
+            uint64_t seed = region[r];
+            if (r > 0) seed |= region[r - 1] & mask[r];
+            if (seed == 0) {
+                continue;
+            }
+            uint64_t grown = spanFill(seed, mask[r]);
+            if (grown != region[r]) {
+                region[r] = grown;
+                changed = true;
+            }
+        }
+        for (int r = rows - 2; r >= 0; r--) {
+            uint64_t seed = region[r + 1] & mask[r];
+            if ((seed & ~region[r]) == 0) {
+                continue;
+            }
+            region[r] = spanFill(region[r] | seed, mask[r]);
+            changed = true;
+        }
+    }
+}
+
+// the group containing index, as rows words (all zero for an empty cell)
+void BitBoard::region(int index, uint64_t *out) const {
+    std::fill(out, out + rows, 0);
+    if (cell[index] == '.') {
+        return;
+    }
+    out[index / cols] = 1ULL << (index % cols);
+    flood(plane[(unsigned char)cell[index]], out);
+}
+
+void BitBoard::set(int index, char value) {
+    if (cell[index] == value) {
+        return;
+    }
+    int row = index / cols;
+    uint64_t bit = 1ULL << (index % cols);
+    if (cell[index] != '.') {
+        int word = plane[(unsigned char)cell[index]] * rows + row;
+        setWord(word, bits[word] & ~bit);
+    }
+    if (value != '.') {
+        int word = plane[(unsigned char)value] * rows + row;
+        setWord(word, bits[word] | bit);
+    }
+    setCell(index, value);
+}
+
+void BitBoard::swapCells(int a, int b) {
+    char first = cell[a];
+    char second = cell[b];
+    if (first == second) {
+        return;
+    }
+    set(a, second);
+    set(b, first);
+}
+
+int BitBoard::score(int index) {
+    if (cell[index] == '.') {
+        return 0;
+    }
+    std::vector<uint64_t> group(rows);
+    region(index, group.data());
+
+    int p = plane[(unsigned char)cell[index]];
+    int points = 0;
+    for (int r = 0; r < rows; r++) {
+        if (group[r] == 0) {
+            continue;
+        }
+        points += __builtin_popcountll(group[r]);
+        setWord(p * rows + r, bits[p * rows + r] & ~group[r]);
+        for (uint64_t left = group[r]; left; left &= left - 1) {
+            setCell(r * cols + __builtin_ctzll(left), '.');
+        }
+    }
+    return points * color[(unsigned char)letter[p]];
+}
+
+int BitBoard::empties() const {
+    return empty;
+}
+
+size_t BitBoard::mark() const {
+    return log.size();
+}
+
+void BitBoard::undo(size_t mark) {
+    while (log.size() > mark) {
+        const LogEntry &entry = log.back();
+        if (entry.kind == LOG_CELL) {
+            hash ^= key(entry.index, cell[entry.index]) ^ key(entry.index, entry.value);
+            empty += (entry.value == '.') - (cell[entry.index] == '.');
+            cell[entry.index] = entry.value;
+        } else {
+            bits[entry.index] = entry.value;
+        }
+        log.pop_back();
+    }
+}
+
+int BitBoard::groupSize(int index) const {
+    std::vector<uint64_t> group(rows);
+    region(index, group.data());
+    int size = 0;
+    for (int r = 0; r < rows; r++) {
+        size += __builtin_popcountll(group[r]);
+    }
+    return size;
+}
+
+bool BitBoard::groupTouchesGoal(int index) const {
+    std::vector<uint64_t> group(rows);
+    region(index, group.data());
+    for (int r = 0; r < rows; r++) {
+        if (group[r] & goalBits[r]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BitBoard::scoringSets(std::vector<ScoringSet> &sets) const {
+    sets.clear();
+    std::vector<uint64_t> left(rows), group(rows);
+    for (size_t p = 0; p < letter.size(); p++) {
+        // only groups with a goal cell can score, so only goal cells seed
+        // a fill; each fill then takes every other goal cell it reaches
+        int total = 0;
+        for (int r = 0; r < rows; r++) {
+            left[r] = bits[p * rows + r] & goalBits[r];
+            total += __builtin_popcountll(bits[p * rows + r]);
+        }
+        if (total < min) {
+            continue;
+        }
+
+        for (int r = 0; r < rows; r++) {
+            while (left[r] != 0) {
+                std::fill(group.begin(), group.end(), 0);
+                group[r] = left[r] & -left[r];
+                flood(p, group.data());
+
+                int size = 0;
+                int scoringCell = -1;
+                for (int g = 0; g < rows; g++) {
+                    size += __builtin_popcountll(group[g]);
+                    uint64_t hit = group[g] & goalBits[g];
+                    if (hit != 0) {
+                        scoringCell = g * cols + 63 - __builtin_clzll(hit);
+                    }
+                    left[g] &= ~group[g];
+                }
+
+                if (size >= min && scoringCell != -1) {
+                    sets.push_back({size, letter[p], scoringCell / cols, scoringCell % cols});
+                }
+            }
+        }
+    }
+}
+
+// Spawning ----------------------------------------------------------------------
+
+template <class Engine>
+int spawnTiles(Engine &board, int count, uint64_t &state) {
+    char letters[26];
+    int colors = 0;
+    for (int ch = 'a'; ch <= 'z'; ch++) {
+        if (board.color[ch] != 0) {
+            letters[colors++] = ch;
+        }
+    }
+
+    std::vector<int> empty;
+    for (int i = 0; i < board.rows * board.cols; i++) {
+        if (board.cell[i] == '.') {
+            empty.push_back(i);
+        }
+    }
+
+    int placed = 0;
+    while (placed < count && !empty.empty()) {
+        size_t pick = next(state) % empty.size();
+        board.set(empty[pick], letters[next(state) % colors]);
+        empty[pick] = empty.back();
+        empty.pop_back();
+        placed++;
+    }
+    return placed;
+}
+
+// Player ------------------------------------------------------------------------
+
+// What the game being over is worth from here on, wherever the search
+// meets it: far below any live position, so points already banked on the
+// way decide between lines that all end, and ending early never "wins"
+const double GAME_OVER = -1e6;
+
+static double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <class Engine>
+Player<Engine>::Player(const SearchOptions &options)
+    : depthReached(0), nodes(0), options(options), table(1 << 16), state(options.seed),
+      deadline(0), stopped(false) {
+    for (size_t i = 0; i < table.size(); i++) {
+        table[i] = Entry{0, 0, 0};
+    }
+}
+
+template <class Engine>
+bool Player<Engine>::outOfTime() {
+    if (!stopped && now() > deadline) {
+        stopped = true;
+    }
+    return stopped;
+}
+
+// what a position is worth with no more lookahead, in points: the best set
+// that could be cashed right now, a little for groups already growing on a
+// goal, and a penalty as the board fills up and the game nears its end
+template <class Engine>
+double Player<Engine>::leaf(const Engine &board) {
+    board.scoringSets(sets);
+
+    int best = 0;
+    for (size_t i = 0; i < sets.size(); i++) {
+        best = std::max(best, sets[i].size * board.color[(unsigned char)sets[i].color]);
+    }
+
+    int reach = 0;
+    for (int i = 0; i < board.rows * board.cols; i++) {
+        if (board.goal[i] && board.cell[i] != '.') {
+            reach += board.groupSize(i) * board.color[(unsigned char)board.cell[i]];
+        }
+    }
+
+    int empty = board.empties();
+    double crowding = empty < 10 ? (10 - empty) * 4.0 : 0.0;
+    return best + reach * 0.1 - crowding;
+}
+
+template <class Engine>
+int Player<Engine>::apply(Engine &board, const Move &move) {
+    if (move.score) {
+        return board.score(move.a);
+    }
+    board.swapCells(move.a, move.b);
+    return 0;
+}
+
+// every legal move from board, best first by points plus the leaf value of
+// the position it leaves (before any tiles spawn)
+template <class Engine>
+void Player<Engine>::candidates(Engine &board, std::vector<Candidate> &out) {
+    out.clear();
+
+    std::vector<ScoringSet> sets;
+    board.scoringSets(sets);
+    for (size_t i = 0; i < sets.size(); i++) {
+        out.push_back({{true, sets[i].row * board.cols + sets[i].col, -1}, 0, 0});
+    }
+
+    int cells = board.rows * board.cols;
+    for (int i = 0; i < cells; i++) {
+        if (board.cell[i] == '.') {
+            continue;
+        }
+        for (int j = i + 1; j < cells; j++) {
+            if (board.cell[j] != '.' && board.cell[j] != board.cell[i]) {
+                out.push_back({{false, i, j}, 0, 0});
+            }
+        }
+    }
+
+    // a swap that leaves too few empties for the spawn ends the game
+    bool ends = board.empties() < options.swapSpawn;
+
+    size_t start = board.mark();
+    for (size_t i = 0; i < out.size(); i++) {
+        Candidate &c = out[i];
+        c.points = apply(board, c.move);
+        c.rank = c.points + ((!c.move.score && ends) ? GAME_OVER : leaf(board));
+        board.undo(start);
+        nodes++;
+    }
+
+    std::stable_sort(out.begin(), out.end(), [](const Candidate &x, const Candidate &y) {
+        return x.rank > y.rank;
+    });
+}
+
+// best value reachable from board with depth of our moves left; the move
+// that gets it goes in *best when best isn't null
+template <class Engine>
+double Player<Engine>::search(Engine &board, int depth, Move *best) {
+    std::vector<Candidate> moves;
+    candidates(board, moves);
+    if (moves.empty()) {
+        return leaf(board);
+    }
+    if (depth == 1) {
+        if (best != nullptr) {
+            *best = moves[0].move;
+        }
+        return moves[0].rank;
+    }
+
+    size_t width = std::min(moves.size(), (size_t)options.beam);
+    double bestValue = -1e18;
+    size_t start = board.mark();
+    for (size_t i = 0; i < width && !outOfTime(); i++) {
+        const Move &move = moves[i].move;
+        int spawn = move.score ? options.scoreSpawn : options.swapSpawn;
+        int points = apply(board, move);
+        double value = points + chance(board, depth - 1, spawn);
+        board.undo(start);
+
+        if (value > bestValue) {
+            bestValue = value;
+            if (best != nullptr) {
+                *best = move;
+            }
+        }
+    }
+    return bestValue;
+}
+
+// expected value of board right after one of our moves, averaged over
+// sampled spawns of spawn tiles
+template <class Engine>
+double Player<Engine>::chance(Engine &board, int depth, int spawn) {
+    if (board.empties() < spawn) {
+        return GAME_OVER;
+    }
+
+    uint64_t key = board.hash ^ mix(spawn);
+    Entry &entry = table[key & (table.size() - 1)];
+    if (entry.key == key && entry.depth == depth) {
+        return entry.value;
+    }
+
+    double total = 0;
+    size_t start = board.mark();
+    for (int s = 0; s < options.samples; s++) {
+        spawnTiles(board, spawn, state);
+        total += search(board, depth, nullptr);
+        board.undo(start);
+        if (stopped) {
+            // cut off partway, so don't cache it
+            return total / (s + 1);
+        }
+    }
+
+    entry = Entry{key, depth, total / options.samples};
+    return entry.value;
+}
+
+template <class Engine>
+Move Player<Engine>::choose(Engine &board) {
+    deadline = now() + options.budget;
+    stopped = false;
+    nodes = 0;
+    depthReached = 0;
+
+    // deepen one ply at a time; a ply cut off by the budget has only seen
+    // some of its moves, so the last finished ply's move stands
+    Move best = {false, -1, -1};
+    for (int depth = 1; depth <= options.depth; depth++) {
+        Move found = best;
+        search(board, depth, &found);
+        if (stopped && depth > 1) {
+            break;
+        }
+        best = found;
+        depthReached = depth;
+    }
+    return best;
+}
+
+// the two engines the programs use
+template int spawnTiles(Board &board, int count, uint64_t &state);
+template int spawnTiles(BitBoard &board, int count, uint64_t &state);
+template class Player<Board>;
+template class Player<BitBoard>;
@@ -0,0 +1,218 @@
+// superball.h
+// Board engine shared by sb-analyze and sb-play: keeps every same-colored
+// group labeled with its size and goal contact, and updates only the
+// groups a change actually touches, with an undo log so a move search can
+// try a swap, look at the result, and take it back. BitBoard is a
+// drop-in alternative built on per-color bitboards.
+
+#ifndef SUPERBALL_H
+#define SUPERBALL_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// A group that can be scored right now
+struct ScoringSet {
+    int     size;
+    char    color;
+    int     row;        // a goal cell in the group, where SCORE is played
+    int     col;
+};
+
+class Board {
+public:
+    // color[ch] is the point value of color letter ch (0 for non-colors)
+    Board(int rows, int cols, int min, const std::vector<int> &color);
+
+    // cells holds '.' or a lowercase color per cell, goals holds 1 on goal cells
+    void load(const std::vector<int> &cells, const std::vector<int> &goals);
+
+    int     rows, cols, min;
+    std::vector<int>  color;    // point value per color letter
+    std::vector<char> cell;     // '.' or a lowercase color
+    std::vector<char> goal;     // 1 on goal cells
+    uint64_t          hash;     // Zobrist hash of the cells, kept up to date by every write
+    int               empty;    // count of '.' cells, kept the same way
+
+    void set(int index, char value);    // change one cell, relabel what it touches
+    void swapCells(int a, int b);
+    int  score(int index);              // remove the scoring group at index, return points
+    int  empties() const;
+
+    size_t mark() const;                // undo position, for undo()
+    void   undo(size_t mark);           // roll everything back to mark
+
+    int  groupSize(int index) const;    // 0 for empty cells
+    bool groupTouchesGoal(int index) const;
+    void scoringSets(std::vector<ScoringSet> &sets) const;
+
+private:
+    struct Group {
+        int     size;           // 0 once the group is retired
+        int     goalCells;
+        int     scoringCell;    // highest-numbered goal cell in the group, -1 if none
+        char    color;
+    };
+
+    enum LogKind { LOG_LABEL, LOG_CELL, LOG_GROUP, LOG_NEW_GROUP, LOG_FREE_PUSH, LOG_FREE_POP };
+
+    struct LogEntry {
+        LogKind kind;
+        int     index;
+        int     value;
+        Group   group;
+    };
+
+    std::vector<int>      label;    // group id of each cell, -1 when empty
+    std::vector<Group>    groups;
+    std::vector<int>      freeIds;  // retired group ids ready for reuse
+    std::vector<LogEntry> log;
+    std::vector<int>      pending;  // flood fill work list
+    std::vector<int>      members;  // cells of the group being relabeled or scored
+    std::vector<char>     seen;     // scratch marks for collect(), always left clear
+    std::vector<uint64_t> zobrist;  // index * 26 + letter - 'a'
+
+    uint64_t key(int index, char value) const;
+    int  neighbors(int index, int out[4]) const;
+    void setCell(int index, char value);
+    void setLabel(int index, int id);
+    void setGroup(int id, const Group &group);
+    void retire(int id);
+    int  allocate();
+    void collect(int index, std::vector<int> &cells);
+    void fill(int seed);
+};
+
+// Same interface as Board, but each color is a bitboard (one 64-bit word
+// per row, bit c for column c) and groups are found by shift-and-mask
+// flood fill and counted with popcount. Nothing is cached between calls,
+// so writes are cheap and queries redo the fill. Needs cols <= 64.
+class BitBoard {
+public:
+    BitBoard(int rows, int cols, int min, const std::vector<int> &color);
+
+    void load(const std::vector<int> &cells, const std::vector<int> &goals);
+
+    int     rows, cols, min;
+    std::vector<int>  color;
+    std::vector<char> cell;
+    std::vector<char> goal;
+    uint64_t          hash;     // same Zobrist keys as Board, so both hash a position alike
+    int               empty;
+
+    void set(int index, char value);
+    void swapCells(int a, int b);
+    int  score(int index);
+    int  empties() const;
+
+    size_t mark() const;
+    void   undo(size_t mark);
+
+    int  groupSize(int index) const;
+    bool groupTouchesGoal(int index) const;
+    void scoringSets(std::vector<ScoringSet> &sets) const;
+
+private:
+    enum LogKind { LOG_CELL, LOG_WORD };
+
+    struct LogEntry {
+        LogKind  kind;
+        int      index;     // cell index, or plane * rows + row
+        uint64_t value;
+    };
+
+    std::vector<int>      plane;    // bitboard plane of each color letter, -1 if none
+    std::vector<char>     letter;   // color letter of each plane
+    std::vector<uint64_t> bits;     // plane * rows + row
+    std::vector<uint64_t> goalBits; // one word per row
+    std::vector<LogEntry> log;
+    std::vector<uint64_t> zobrist;  // index * 26 + letter - 'a'
+
+    uint64_t key(int index, char value) const;
+    void setCell(int index, char value);
+    void setWord(int index, uint64_t value);
+    void flood(int p, uint64_t *region) const;
+    void region(int index, uint64_t *out) const;
+};
+
+// splitmix64: mixes a counter into a well spread 64-bit value, used for the
+// Zobrist keys and as a small seeded PRNG (next(state) advances state)
+inline uint64_t mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+inline uint64_t next(uint64_t &state) {
+    return mix(state++);
+}
+
+// Drops count random tiles of random colors on random empty cells, the
+// way the game does after every move; returns how many actually fit.
+// Defined for Board and BitBoard.
+template <class Engine>
+int spawnTiles(Engine &board, int count, uint64_t &state);
+
+// One move: SCORE at cell a, or SWAP cells a and b
+struct Move {
+    bool    score;
+    int     a, b;
+};
+
+struct SearchOptions {
+    int      depth;         // plies of our own moves, 1 is plain greedy
+    int      beam;          // best-ranked moves expanded at each deeper ply
+    int      samples;       // random spawns tried after each expanded move
+    int      swapSpawn;     // tiles dropped after a SWAP
+    int      scoreSpawn;    // tiles dropped after a SCORE
+    double   budget;        // seconds allowed per move
+    uint64_t seed;
+};
+
+// Beam-limited expectimax over our moves and sampled tile spawns, deepened
+// one ply at a time until the budget runs out. Chance nodes (the board
+// right after our move) are cached by Zobrist hash, so positions reached
+// by different move orders, or seen again on a later turn, are not redone.
+// Engine is Board or BitBoard; superball.cpp defines both.
+template <class Engine>
+class Player {
+public:
+    explicit Player(const SearchOptions &options);
+
+    Move choose(Engine &board);
+
+    int      depthReached;  // deepest ply the last choose() finished
+    size_t   nodes;         // positions evaluated by the last choose()
+
+private:
+    struct Entry {
+        uint64_t key;
+        int      depth;
+        double   value;
+    };
+
+    struct Candidate {
+        Move    move;
+        int     points;
+        double  rank;
+    };
+
+    SearchOptions      options;
+    std::vector<Entry> table;
+    uint64_t           state;
+    double             deadline;
+    bool               stopped;
+
+    std::vector<ScoringSet> sets;   // scratch for leaf()
+
+    double leaf(const Engine &board);
+    int    apply(Engine &board, const Move &move);
+    void   candidates(Engine &board, std::vector<Candidate> &out);
+    double search(Engine &board, int depth, Move *best);
+    double chance(Engine &board, int depth, int spawn);
+    bool   outOfTime();
+};
+
+#endif
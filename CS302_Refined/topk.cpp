@@ -0,0 +1,49 @@
+// topk.cpp
+// Overview: partial sort - keeps only the K smallest nodes in a bounded
+// max-heap while walking the list once, so it runs in O(n log K) time with
+// O(K) extra memory, then leaves those K in order as the whole list
+
+#include "volsort.h"
+
+#include <algorithm>
+#include <vector>
+
+void topk_sort(List &l, bool numeric, size_t k) {
+    if (k > l.size) {
+        k = l.size;
+    }
+    if (k == 0) {
+        l.head = nullptr;
+        l.size = 0;
+        return;
+    }
+
+    // heap order puts the largest of the kept nodes at the front
+    auto less = [numeric](const Node *a, const Node *b) {
+        return (numeric ? number_order(a, b) : string_order(a, b)) < 0;
+    };
+
+    std::vector<Node *> heap;
+    heap.reserve(k);
+    for (Node *curr = l.head; curr != nullptr; curr = curr->next) {
+        if (heap.size() < k) {
+            heap.push_back(curr);
+            std::push_heap(heap.begin(), heap.end(), less);
+        } else if (less(curr, heap.front())) {
+            // smaller than the worst one we kept, so it takes that slot
+            std::pop_heap(heap.begin(), heap.end(), less);
+            heap.back() = curr;
+            std::push_heap(heap.begin(), heap.end(), less);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), less);
+
+    // the list is now just the K smallest; the rest stay in the slabs and
+    // are freed with them by ~List
+    for (size_t i = 0; i + 1 < heap.size(); i++) {
+        heap[i]->next = heap[i + 1];
+    }
+    heap.back()->next = nullptr;
+    l.head = heap[0];
+    l.size = k;
+}
@@ -3,22 +3,95 @@
 #ifndef VOLSORT_H
 #define VOLSORT_H
 
+#include <algorithm>
 #include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <functional>
 
 struct Node {
     std::string string;
-    int         number;
+    long long   number;
+    uint64_t    prefix;     // first 8 bytes of string, big-endian, zero padded
     Node       *next;
 };
 
+// The benchmark build (-DVOLSORT_BENCH) counts every key comparison made
+// through the helpers below, plus the ones sorts tally in bulk with
+// COUNT_COMPARISONS; normal builds compile the counter away.
+#ifdef VOLSORT_BENCH
+#include <atomic>
+extern std::atomic<size_t> comparisons;	// define in bench.cpp
+#define COUNT_COMPARISONS(n) comparisons.fetch_add((n), std::memory_order_relaxed)
+#else
+#define COUNT_COMPARISONS(n) ((void)0)
+#endif
+#define COUNT_COMPARISON() COUNT_COMPARISONS(1)
+
+// Orders two nodes by number: < 0, 0 or > 0 like strcmp.
+inline int number_order(const Node *a, const Node *b) {
+    COUNT_COMPARISON();
+    return (a->number > b->number) - (a->number < b->number);
+}
+
+// Orders two nodes by string; prefix settles most pairs in one integer
+// compare, and only nodes sharing all 8 leading bytes look at the strings.
+inline int string_order(const Node *a, const Node *b) {
+    COUNT_COMPARISON();
+    if (a->prefix != b->prefix) {
+        return a->prefix < b->prefix ? -1 : 1;
+    }
+    return a->string.compare(b->string);
+}
+
+// Value of a line for numeric sorting: all-digit lines parse as decimal,
+// sticking at LLONG_MAX instead of overflowing; anything else is 0.
+inline long long parse_number(const char *s, size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    unsigned long long value = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (s[i] < '0' || s[i] > '9') {
+            return 0;
+        }
+        if (value <= (unsigned long long)(LLONG_MAX - (s[i] - '0')) / 10) {
+            value = value * 10 + (s[i] - '0');
+        } else {
+            value = LLONG_MAX;
+        }
+    }
+    return (long long)value;
+}
+
+// Nodes are carved out of large contiguous slabs instead of one new per line,
+// so they sit in memory in insertion order and are released all at once.
+
+const size_t FIRST_SLAB_NODES = 1 << 6;	// nodes in the first slab; each next one doubles
+const size_t SLAB_NODES = 1 << 16;		// ...up to this many
+
+// Nodes slab number index holds; small lists stay small this way
+inline size_t slab_nodes(size_t index) {
+    return index >= 10 ? SLAB_NODES : std::min(SLAB_NODES, FIRST_SLAB_NODES << index);
+}
+
 struct List {
     Node       *head;
     size_t      size;
 
+    std::vector<Node *> slabs;			// raw storage, slab_nodes(i) each
+    size_t      slab_used;			// nodes used in slabs.back()
+
     List(); 					// define in list.cpp
     ~List();					// define in list.cpp
 
+    List(const List &) = delete;
+    List &operator=(const List &) = delete;
+
     void push_front(const std::string &s);	// also define in list.cpp
+    Node *allocate();				// hands out the next slab slot
 };
 
 
@@ -28,5 +101,12 @@ void stl_sort(List &l, bool numeric);	// define in stl.cpp - sort using std::sor
 void qsort_sort(List &l, bool numeric);	// define in qsort.cpp - sort using qsort from cstdlib
 void merge_sort(List &l, bool numeric);	// define in merge.cpp - your implementation
 void quick_sort(List &l, bool numeric);	// define in quick.cpp - your implementation
+void radix_sort(List &l, bool numeric);	// define in radix.cpp - LSD (numeric) / MSD (string) radix
+void oblivious_sort(List &l, bool numeric);	// define in oblivious.cpp - bitonic sorting network
+void topk_sort(List &l, bool numeric, size_t k);	// define in topk.cpp - keep only the K smallest, in order
+void pmerge_sort(List &l, bool numeric, size_t threads);	// define in pmerge.cpp - threaded merge sort
+int  mmap_sort(const char *path, bool numeric);	// define in mmap.cpp - sort a mapped file, no List
+int  external_sort(bool numeric, size_t budget, size_t limit, const std::function<void(List &)> &sort);	// define in external.cpp - spill runs to disk, print the first limit lines
+void merge_plan(size_t budget, size_t &fan_in, size_t &buffer);	// define in external.cpp - runs per merge and buffer size for a budget
 
 #endif
@@ -4,131 +4,164 @@
  * Net ID: ttb615, jzr266
  * Student ID: 000-693-721, 000-663-921
  * Program Description: Program that checks if words can be spelled using a set of dice by using the Edmonds-Karp algorithm.
+ *                      (or Hopcroft-Karp, with -e hk)
  */
 
 #include <iostream>
 #include <fstream>
 #include <vector>
-#include <queue>
 #include <string>   
+#include <cstdint>
+#include <cstring>
+#include <unistd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace std;
 
-struct Edge;
-
-// node in graph
-struct Node
+// what a node in the flow network stands for
+enum NodeKind
 {
-    int ID;               // identifier for node (unique for each one)
-    string label;         // shows what kind of node this node is
-    vector<Edge *> edges; // edges from node
-    Edge *backEdge;       // edge used to reach node in BFS
-    bool visited;
-
-    // constructor
-    Node(int ID, const string &label)
-    {
-        this->ID = ID;
-        this->label = label;
-        this->backEdge = NULL;
-        this->visited = false;
-    }
+    SOURCE,
+    DIE,
+    LETTER,
+    SINK
 };
 
-// edge in graph
-struct Edge
+// anything that can match a word's letters to distinct dice; result gets
+// the die used for each letter, in word order
+class Matcher
 {
-    Node *from;    // source node
-    Node *to;      // destination node
-    int capacity;  // how much more flow can go through edge
-    Edge *reverse; // reverse of current edge
-
-    // constructor
-    Edge(Node *from, Node *to, int capacity)
-    {
-        this->from = from;
-        this->to = to;
-        this->capacity = capacity;
-        this->reverse = NULL;
-    }
+public:
+    virtual ~Matcher() {}
+    virtual bool canSpell(const string &word, vector<int> &result) = 0;
 };
 
-// graph for dice-letter connections
-class Graph
+// flow network for dice-letter connections, stored as flat arrays. Nodes
+// are numbered source (0), dice (1..numDice), letters, sink. Edges come in
+// pairs, so edge e's reverse is always e ^ 1. The source and dice layer is
+// built once; each word only truncates and rebuilds the letter layer, and
+// adjacency is a CSR index (edges of node n are adj[start[n]..start[n+1]))
+// that keeps edges in the order they were added.
+class Graph : public Matcher
 {
 public:
-    vector<Node *> nodes; // all nodes in graph
-    Node *source;         // source node
-    Node *sink;           // sink node
-    size_t diceEnd;       // end of dice nodes
+    vector<char> kind;      // NodeKind of every node
+    vector<int> edgeFrom;   // edge e goes edgeFrom[e] -> edgeTo[e]
+    vector<int> edgeTo;
+    vector<int> capacity;   // how much more flow can go through edge e
+    vector<int> start;      // CSR offsets into adj, one past the end for the last node
+    vector<int> adj;        // edge ids grouped by their from node
+
+    vector<int> backEdge;   // edge used to reach node in BFS
+    vector<int> visited;    // BFS round that last reached the node
+    vector<int> nodeQueue;  // BFS queue, reused
+    int round;
+
+    int numDice;
+    int sink;
+    int diceEdges;          // edges in the source/dice layer
+    vector<bool> hasFace;   // hasFace[die * 256 + letter]
 
-    // make graph with nodes
-    Graph(size_t numDice)
+    // make graph with source and dice nodes, plus the edges between them
+    Graph(const vector<string> &dice)
     {
-        source = new Node(0, "SOURCE");
-        nodes.push_back(source);
-        for (size_t i = 0; i < numDice; ++i)
+        numDice = dice.size();
+        kind.push_back(SOURCE);
+        kind.insert(kind.end(), numDice, DIE);
+
+        hasFace.assign(numDice * 256, false);
+        for (int i = 0; i < numDice; ++i)
         {
-            int ID = i + 1;
-            nodes.push_back(new Node(ID, "DIE"));
+            addEdge(0, i + 1);
+            for (size_t f = 0; f < dice[i].size(); ++f)
+            {
+                hasFace[i * 256 + (unsigned char)dice[i][f]] = true;
+            }
         }
-        diceEnd = nodes.size(); // save position after dice nodes
+        diceEdges = edgeTo.size();
+        sink = 0;
+        round = 0;
+    }
+
+    // adds directed edge and its reverse
+    void addEdge(int fromNode, int toNode, int cap = 1)
+    {
+        edgeFrom.push_back(fromNode);
+        edgeTo.push_back(toNode);
+        capacity.push_back(cap);
+        edgeFrom.push_back(toNode);
+        edgeTo.push_back(fromNode);
+        capacity.push_back(0);
     }
 
-    // reset graph
+    // drops the letter layer and restores the dice layer to full capacity
     void reset()
     {
-        while (nodes.size() > diceEnd)
+        kind.resize(numDice + 1);
+        edgeFrom.resize(diceEdges);
+        edgeTo.resize(diceEdges);
+        capacity.resize(diceEdges);
+        for (int e = 0; e < diceEdges; e += 2)
         {
-            delete nodes.back();
-            nodes.pop_back();
+            capacity[e] = 1;
+            capacity[e + 1] = 0;
         }
     }
 
-    // adds directed edge
-    void addEdge(Node *fromNode, Node *toNode, int cap = 1)
+    // groups edges by from node (counting sort, stable so BFS order is kept)
+    void buildIndex()
     {
-        Edge *forwardEdge = new Edge(fromNode, toNode, cap);
-        Edge *reverseEdge = new Edge(toNode, fromNode, 0);
-        forwardEdge->reverse = reverseEdge;
-        reverseEdge->reverse = forwardEdge;
-        fromNode->edges.push_back(forwardEdge);
-        toNode->edges.push_back(reverseEdge);
+        size_t numNodes = kind.size();
+        start.assign(numNodes + 1, 0);
+        for (size_t e = 0; e < edgeFrom.size(); ++e)
+        {
+            start[edgeFrom[e] + 1]++;
+        }
+        for (size_t n = 0; n < numNodes; ++n)
+        {
+            start[n + 1] += start[n];
+        }
+        adj.resize(edgeFrom.size());
+        vector<int> fill(start.begin(), start.end() - 1);
+        for (size_t e = 0; e < edgeFrom.size(); ++e)
+        {
+            adj[fill[edgeFrom[e]]++] = e;
+        }
+
+        backEdge.assign(numNodes, -1);
+        visited.assign(numNodes, 0);
+        round = 0;
     }
 
     // find path from source to sink
     bool bfs()
     {
-        // reset visited flags and back edges
-        for (vector<Node *>::iterator it = nodes.begin(); it != nodes.end(); ++it)
-        {
-            Node *n = *it;
-            n->visited = false;
-            n->backEdge = NULL;
-        }
-
-        queue<Node *> nodeQueue;
-        nodeQueue.push(source);
-        source->visited = true;
+        // a new round number marks every node unvisited
+        ++round;
+        nodeQueue.clear();
+        nodeQueue.push_back(0);
+        visited[0] = round;
 
         // breadth-first search
-        while (!nodeQueue.empty())
+        for (size_t head = 0; head < nodeQueue.size(); ++head)
         {
-            Node *fromNode = nodeQueue.front();
-            nodeQueue.pop();
-
-            for (vector<Edge *>::iterator it = fromNode->edges.begin(); it != fromNode->edges.end(); ++it)
+            int fromNode = nodeQueue[head];
+            for (int i = start[fromNode]; i < start[fromNode + 1]; ++i)
             {
-                Edge *currentEdge = *it;
-                if (currentEdge->capacity > 0 && !currentEdge->to->visited)
+                int e = adj[i];
+                int toNode = edgeTo[e];
+                if (capacity[e] > 0 && visited[toNode] != round)
                 {
-                    currentEdge->to->visited = true;
-                    currentEdge->to->backEdge = currentEdge;
-                    if (currentEdge->to == sink)
+                    visited[toNode] = round;
+                    backEdge[toNode] = e;
+                    if (toNode == sink)
                     {
                         return true; // found path
                     }
-                    nodeQueue.push(currentEdge->to);
+                    nodeQueue.push_back(toNode);
                 }
             }
         }
@@ -136,60 +169,47 @@ public:
     }
 
     // sees if a word can be spelled using dice
-    bool canSpell(string &word, vector<string> &dice, vector<int> &result)
+    bool canSpell(const string &word, vector<int> &result) override
     {
         reset();
 
-        vector<Node *> letterNodes;
-
-        // node for all letters in word
-        for (size_t i = 0; i < word.size(); ++i)
-        {
-            Node *ln = new Node(nodes.size(), string(1, word[i]));
-            nodes.push_back(ln);
-            letterNodes.push_back(ln);
-        }
-
-        // sink node
-        sink = new Node(nodes.size(), "SINK");
-        nodes.push_back(sink);
-
-        // connect source to dice nodes
-        for (size_t i = 1; i <= dice.size(); ++i)
-        {
-            addEdge(source, nodes[i]);
-        }
+        // node for all letters in word, then the sink
+        int firstLetter = kind.size();
+        kind.insert(kind.end(), word.size(), LETTER);
+        sink = kind.size();
+        kind.push_back(SINK);
 
         // connect dice nodes to matching letter nodes
-        for (size_t i = 0; i < dice.size(); ++i)
+        for (int i = 0; i < numDice; ++i)
         {
             for (size_t j = 0; j < word.size(); ++j)
             {
-                if (dice[i].find(word[j]) != string::npos)
+                if (hasFace[i * 256 + (unsigned char)word[j]])
                 {
-                    addEdge(nodes[i + 1], letterNodes[j]);
+                    addEdge(i + 1, firstLetter + j);
                 }
             }
         }
 
         // connect letter nodes to sink
-        for (size_t i = 0; i < letterNodes.size(); ++i)
+        for (size_t j = 0; j < word.size(); ++j)
         {
-            addEdge(letterNodes[i], sink);
+            addEdge(firstLetter + j, sink);
         }
 
+        buildIndex();
+
         // Edmonds-Karp to find maximum matching
         int flow = 0;
         while (bfs())
         {
             // go back to source and change capacities
-            Node *currentNode = sink;
-            while (currentNode != source)
+            for (int currentNode = sink; currentNode != 0; )
             {
-                Edge *currentEdge = currentNode->backEdge;
-                currentEdge->capacity -= 1;
-                currentEdge->reverse->capacity += 1;
-                currentNode = currentEdge->from;
+                int e = backEdge[currentNode];
+                capacity[e] -= 1;
+                capacity[e ^ 1] += 1;
+                currentNode = edgeFrom[e];
             }
             ++flow;
         }
@@ -204,13 +224,13 @@ public:
         result.clear();
         for (size_t j = 0; j < word.size(); ++j)
         {
-            Node *ln = nodes[diceEnd + j];
-            for (size_t i = 0; i < ln->edges.size(); ++i)
+            int ln = firstLetter + j;
+            for (int i = start[ln]; i < start[ln + 1]; ++i)
             {
-                Edge *currentEdge = ln->edges[i];
-                if (currentEdge->to->label == "DIE" && currentEdge->capacity > 0)
+                int e = adj[i];
+                if (kind[edgeTo[e]] == DIE && capacity[e] > 0)
                 {
-                    result.push_back(currentEdge->to->ID - 1); // dice index
+                    result.push_back(edgeTo[e] - 1); // dice index
                     break;
                 }
             }
@@ -220,9 +240,289 @@ public:
     }
 };
 
+// Hopcroft-Karp on the letters-vs-dice bipartite graph. Each letter value
+// has a bitset of the dice showing it, so a letter's neighbors are just the
+// set bits of one mask. Every phase finds a maximal set of shortest
+// augmenting paths at once (BFS layers, then DFS along them), which takes
+// O(sqrt(V)) phases instead of one BFS per letter.
+class HopcroftKarp : public Matcher
+{
+public:
+    int numDice;
+    int words;                // 64-bit words per mask
+    vector<uint64_t> faces;   // faces[letter * words + w]: dice showing letter
+    vector<int> matchDie;     // letter position matched to each die, -1 if none
+    vector<int> matchLetter;  // die matched to each letter position, -1 if none
+    vector<int> dist;         // BFS layer of each letter position
+    vector<int> layerQueue;
+    int freeLayer;            // first layer whose letters see a free die
+    const string *word;
+
+    static const int UNREACHED = 1 << 30;
+
+    HopcroftKarp(const vector<string> &dice)
+    {
+        numDice = dice.size();
+        words = (numDice + 63) / 64;
+        faces.assign(256 * words, 0);
+        for (int i = 0; i < numDice; ++i)
+        {
+            for (size_t f = 0; f < dice[i].size(); ++f)
+            {
+                unsigned char letter = dice[i][f];
+                faces[letter * words + i / 64] |= 1ULL << (i % 64);
+            }
+        }
+        matchDie.assign(numDice, -1);
+        word = NULL;
+    }
+
+    const uint64_t *mask(int position) const
+    {
+        return &faces[(unsigned char)(*word)[position] * words];
+    }
+
+    // layers letters by shortest alternating path from a free letter, and
+    // stops at the first layer that reaches a free die so only shortest
+    // augmenting paths are used; true if some free die can be reached
+    bool bfs()
+    {
+        freeLayer = UNREACHED;
+        layerQueue.clear();
+        for (size_t j = 0; j < matchLetter.size(); ++j)
+        {
+            dist[j] = matchLetter[j] == -1 ? 0 : UNREACHED;
+            if (dist[j] == 0)
+            {
+                layerQueue.push_back(j);
+            }
+        }
+
+        for (size_t head = 0; head < layerQueue.size(); ++head)
+        {
+            int u = layerQueue[head];
+            if (dist[u] > freeLayer)
+            {
+                break;
+            }
+            const uint64_t *m = mask(u);
+            for (int w = 0; w < words; ++w)
+            {
+                for (uint64_t bits = m[w]; bits; bits &= bits - 1)
+                {
+                    int d = w * 64 + __builtin_ctzll(bits);
+                    int v = matchDie[d];
+                    if (v == -1)
+                    {
+                        freeLayer = min(freeLayer, dist[u]);
+                    }
+                    else if (dist[v] == UNREACHED)
+                    {
+                        dist[v] = dist[u] + 1;
+                        layerQueue.push_back(v);
+                    }
+                }
+            }
+        }
+        return freeLayer != UNREACHED;
+    }
+
+    // augments from letter u along the BFS layers; a free die only ends
+    // the path at freeLayer, and nothing goes deeper than that
+    bool dfs(int u)
+    {
+        const uint64_t *m = mask(u);
+        for (int w = 0; w < words; ++w)
+        {
+            for (uint64_t bits = m[w]; bits; bits &= bits - 1)
+            {
+                int d = w * 64 + __builtin_ctzll(bits);
+                int v = matchDie[d];
+                bool augments = v == -1 ? dist[u] == freeLayer
+                                        : dist[u] < freeLayer && dist[v] == dist[u] + 1 && dfs(v);
+                if (augments)
+                {
+                    matchDie[d] = u;
+                    matchLetter[u] = d;
+                    return true;
+                }
+            }
+        }
+        dist[u] = UNREACHED; // dead end, don't try it again this phase
+        return false;
+    }
+
+    bool canSpell(const string &w, vector<int> &result) override
+    {
+        word = &w;
+        int length = w.size();
+        matchLetter.assign(length, -1);
+        dist.assign(length, 0);
+
+        int matched = 0;
+        if (length <= numDice)
+        {
+            while (matched < length && bfs())
+            {
+                for (int j = 0; j < length; ++j)
+                {
+                    if (matchLetter[j] == -1 && dfs(j))
+                    {
+                        ++matched;
+                    }
+                }
+            }
+        }
+
+        // hand the dice back for the next word
+        result.clear();
+        for (int j = 0; j < length; ++j)
+        {
+            if (matchLetter[j] != -1)
+            {
+                matchDie[matchLetter[j]] = -1;
+                result.push_back(matchLetter[j]);
+            }
+        }
+        return matched == length;
+    }
+};
+
+// builds the matcher for engine ("ek" or "hk"), NULL if there is no such engine
+Matcher *makeMatcher(const string &engine, const vector<string> &dice)
+{
+    if (engine == "ek")
+    {
+        return new Graph(dice);
+    }
+    if (engine == "hk")
+    {
+        return new HopcroftKarp(dice);
+    }
+    return NULL;
+}
+
+// appends the answer for one word to out, in the usual output format
+void formatResult(const string &word, bool spelled, const vector<int> &IDs, string &out)
+{
+    if (!spelled)
+    {
+        out += "Cannot spell ";
+        out += word;
+        out += '\n';
+        return;
+    }
+
+    // indices of dice used
+    for (size_t j = 0; j < IDs.size(); ++j)
+    {
+        out += to_string(IDs[j]);
+        if (j + 1 < IDs.size())
+        {
+            out += ',';
+        }
+    }
+    out += ": ";
+    out += word;
+    out += '\n';
+}
+
+// Words handed to a worker at a time, and how many chunks may be finished
+// but not yet printed before workers wait for the printer to catch up
+const size_t CHUNK_WORDS = 256;
+const size_t REORDER_WINDOW = 64;
+
+// Reorder buffer: workers claim chunks of words in order, each with its
+// own matcher, and drop the formatted output into the chunk's slot; the
+// main thread prints slots strictly in chunk order as they fill in.
+struct ReorderBuffer
+{
+    vector<string> slots;    // output for chunk k lives in slots[k % REORDER_WINDOW]
+    vector<bool> ready;
+    size_t nextClaim;        // next chunk a worker may take
+    size_t nextPrint;        // next chunk the printer is waiting on
+    mutex lock;
+    condition_variable filled;
+    condition_variable drained;
+
+    ReorderBuffer() : slots(REORDER_WINDOW), ready(REORDER_WINDOW, false), nextClaim(0), nextPrint(0) {}
+};
+
+void worker(const string &engine, const vector<string> &dice, const vector<string> &words,
+            ReorderBuffer &buffer)
+{
+    Matcher *matcher = makeMatcher(engine, dice);
+    vector<int> IDs;
+    size_t chunks = (words.size() + CHUNK_WORDS - 1) / CHUNK_WORDS;
+    string out;
+
+    while (true)
+    {
+        // claim the next chunk, waiting if it would overrun the window
+        size_t chunk;
+        {
+            unique_lock<mutex> guard(buffer.lock);
+            if (buffer.nextClaim >= chunks)
+            {
+                break;
+            }
+            chunk = buffer.nextClaim++;
+            buffer.drained.wait(guard, [&]() { return chunk < buffer.nextPrint + REORDER_WINDOW; });
+        }
+
+        out.clear();
+        size_t last = min(words.size(), (chunk + 1) * CHUNK_WORDS);
+        for (size_t i = chunk * CHUNK_WORDS; i < last; ++i)
+        {
+            bool spelled = matcher->canSpell(words[i], IDs);
+            formatResult(words[i], spelled, IDs, out);
+        }
+
+        {
+            lock_guard<mutex> guard(buffer.lock);
+            buffer.slots[chunk % REORDER_WINDOW].swap(out);
+            buffer.ready[chunk % REORDER_WINDOW] = true;
+        }
+        buffer.filled.notify_one();
+    }
+
+    delete matcher;
+}
+
+void usage()
+{
+    cerr << "usage: worddice [-e ek|hk] [-j N] dice-file word-file" << endl
+         << "    -e   matching engine: Edmonds-Karp flow (ek, default) or Hopcroft-Karp (hk)" << endl
+         << "    -j   check words on N threads (output stays in input order)" << endl;
+    exit(1);
+}
+
 int main(int argc, char *argv[])
 {
-    ifstream diceFile(argv[1]), wordFile(argv[2]);
+    string engine = "ek";
+    int threads = 1;
+    int c;
+    while ((c = getopt(argc, argv, "e:j:")) != -1)
+    {
+        if (c == 'e')
+        {
+            engine = optarg;
+        }
+        else if (c == 'j' && atoi(optarg) > 0)
+        {
+            threads = atoi(optarg);
+        }
+        else
+        {
+            usage();
+        }
+    }
+    if (argc - optind != 2)
+    {
+        usage();
+    }
+
+    ifstream diceFile(argv[optind]), wordFile(argv[optind + 1]);
     vector<string> dice, words;
 
     // read dice from file
@@ -243,30 +543,58 @@ int main(int argc, char *argv[])
         }
     }
 
-    // for all words, check if it can be spelled with dice
-    for (size_t i = 0; i < words.size(); ++i)
+    // one matcher for every word; only its letter layer changes
+    Matcher *matcher = makeMatcher(engine, dice);
+    if (!matcher)
+    {
+        usage();
+    }
+
+    if (threads == 1)
     {
-        string &w = words[i];
-        Graph g(dice.size());
         vector<int> IDs;
-        if (g.canSpell(w, dice, IDs))
+        string out;
+
+        // for all words, check if it can be spelled with dice
+        for (size_t i = 0; i < words.size(); ++i)
         {
-            // print indices of dice used
-            for (size_t j = 0; j < IDs.size(); ++j)
-            {
-                cout << IDs[j];
-                if (j + 1 < IDs.size())
-                {
-                    cout << ',';
-                }
-            }
-            cout << ": " << w << "\n";
+            out.clear();
+            formatResult(words[i], matcher->canSpell(words[i], IDs), IDs, out);
+            cout << out;
         }
-        else
+
+        delete matcher;
+        return 0;
+    }
+    delete matcher;
+
+    // every worker builds its own matcher; this thread only prints
+    ReorderBuffer buffer;
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t)
+    {
+        workers.push_back(thread(worker, cref(engine), cref(dice), cref(words), ref(buffer)));
+    }
+
+    size_t chunks = (words.size() + CHUNK_WORDS - 1) / CHUNK_WORDS;
+    string out;
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
         {
-            cout << "Cannot spell " << w << "\n";
+            unique_lock<mutex> guard(buffer.lock);
+            size_t slot = chunk % REORDER_WINDOW;
+            buffer.filled.wait(guard, [&]() { return (bool)buffer.ready[slot]; });
+            out.swap(buffer.slots[slot]);
+            buffer.ready[slot] = false;
+            buffer.nextPrint = chunk + 1;
         }
+        buffer.drained.notify_all();
+        cout << out;
     }
 
+    for (size_t t = 0; t < workers.size(); ++t)
+    {
+        workers[t].join();
+    }
     return 0;
 }